@@ -1,187 +1,465 @@
-typedef struct {
-    int Valid;
-    int PreviousType;
-    int Offset;
-} MedecineCell;
+// Specialized programs receive the grid, the partitions and the rules as -D build options, generic ones read the kernel arguments
+#ifndef CANCER_THRESHOLD
+#define CANCER_THRESHOLD 6
+#endif
+#ifndef CURE_THRESHOLD
+#define CURE_THRESHOLD 6
+#endif
+#ifdef NUMBER_OF_CELL_X
+#define CELLS_X NUMBER_OF_CELL_X
+#define CELLS_Y NUMBER_OF_CELL_Y
+#define PARTITION_ROWS ROWS_PER_PARTITION
+#else
+#define CELLS_X numberOfCellInX
+#define CELLS_Y numberOfCellInY
+#define PARTITION_ROWS rowsPerPartition
+#endif
+#define CELLS (CELLS_X * CELLS_Y)
 
-__kernel void calculate_positions(__global float* result, float2 offset, float cellSize, int numberOfCell_X) 
+// The grid is stored with a ring of ghost cells around it and a ghost row between two partitions, it has to match GhostLayout
+// The ring holds the border, the rows between the partitions are void so that every cell reads its neighbors at the same offsets
+#define STRIDE (CELLS_X + 2)
+#define PADDED_ROWS (CELLS_Y + (CELLS_Y - 1) / PARTITION_ROWS + 2)
+#ifndef BORDER_CELL
+#define BORDER_CELL 0xFF
+#endif
+
+// Tiles of the activity map over the padded grid, work-groups of the tiled kernels never straddle them
+#ifndef ACTIVITY_TILE_SIZE
+#define ACTIVITY_TILE_SIZE 16
+#endif
+#define ACTIVITY_TILES_X ((STRIDE + ACTIVITY_TILE_SIZE - 1) / ACTIVITY_TILE_SIZE)
+#define ACTIVITY_TILES_Y ((PADDED_ROWS + ACTIVITY_TILE_SIZE - 1) / ACTIVITY_TILE_SIZE)
+
+#define CELL_CANCER 0
+#define CELL_HEALTHY 1
+#define CELL_MEDECINE 2
+// Cancer cell surrounded by enough medecine, it turns healthy and consumes the medecine around it
+#define CELL_CURED 3
+
+// One byte per cell, the type in bits 0-1, the type covered by a medecine cell in bit 2 and its direction in bits 3-5
+#define STATE_TYPE_MASK 0x3
+#define STATE_PREVIOUS_TYPE_SHIFT 2
+#define STATE_DIRECTION_SHIFT 3
+
+int get_type(uchar state)
 {
-    int i = get_global_id(0);
+    return state & STATE_TYPE_MASK;
+}
 
-    float2 position = (float2)(((float)(i % numberOfCell_X) - offset.x) * cellSize, ((float)(i / numberOfCell_X) - offset.y) * cellSize);
-    vstore2(position, i, result);
+int get_previous_type(uchar state)
+{
+    return (state >> STATE_PREVIOUS_TYPE_SHIFT) & 0x1;
 }
 
-__kernel void set_cells(__global int* readCells, __global int* cellTypes, __global float* cellColor)
+int get_direction(uchar state)
 {
-    int i = get_global_id(0);
+    return (state >> STATE_DIRECTION_SHIFT) & 0x7;
+}
 
-    cellTypes[i] = 1;
-    float4 color = (float4)(0.0f, 1.0f, 0.0f, 1.0f);
+uchar pack_medecine(int previousType, int direction)
+{
+    return (uchar)(CELL_MEDECINE | previousType << STATE_PREVIOUS_TYPE_SHIFT | direction << STATE_DIRECTION_SHIFT);
+}
 
-    vstore4(color, i, cellColor);
+__constant int NeighborOffsetX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+__constant int NeighborOffsetY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
 
-    if (readCells[i] == 1)
-    {
-        cellTypes[i] = 0;
-        color = (float4)(0.75f, 0.0f, 0.0f, 1.0f);
+int get_activity_tile(int x, int y, int numberOfCellInX)
+{
+    return y / ACTIVITY_TILE_SIZE * ACTIVITY_TILES_X + x / ACTIVITY_TILE_SIZE;
+}
 
-        vstore4(color, i, cellColor);
-    }
+int get_padded_row(int y, int rowsPerPartition)
+{
+    return y + y / PARTITION_ROWS + 1;
 }
 
-__kernel void update_healthy_cancer_cells(__constant int* numberOfCellsPerPartition, __global int* readCells, __global float4* readColors,
-    __constant int* indexes, __constant int* neighbors,
-    __global int* cellTypes, __global float* cellColor,
-    __global int* updatedCells)
+int get_padded_index(int x, int y, int numberOfCellInX, int rowsPerPartition)
 {
-    int i = get_global_id(0);
+    return get_padded_row(y, PARTITION_ROWS) * STRIDE + x + 1;
+}
+
+// The last row is the ghost ring, not a seam
+bool is_seam_row(int row, int numberOfCellInY, int rowsPerPartition)
+{
+    return row > 0 && row < PADDED_ROWS - 1 && (row - 1) % (PARTITION_ROWS + 1) == PARTITION_ROWS;
+}
+
+// Ghosts are never stepped, they keep the values they were created with in every buffer
+bool is_cell(int x, int row, int numberOfCellInX, int numberOfCellInY, int rowsPerPartition)
+{
+    return x >= 1 && x <= CELLS_X && row >= 1 && row < PADDED_ROWS - 1 && !is_seam_row(row, CELLS_Y, PARTITION_ROWS);
+}
+
+// Medecine moves across the seams, its source is the row on the other side of the ghost row
+int get_source_row(int row, int j, int numberOfCellInY, int rowsPerPartition)
+{
+    int sourceRow = row - NeighborOffsetY[j];
+    return is_seam_row(sourceRow, CELLS_Y, PARTITION_ROWS) ? sourceRow - NeighborOffsetY[j] : sourceRow;
+}
+
+// A tile is stepped when it or one of its neighbors changed during the last generation
+// A cell only depends on the cells up to four padded rows away, the tiles that are skipped keep the same states in both buffers
+__kernel void activate_tiles(int numberOfCellInX, int numberOfCellInY, int rowsPerPartition,
+    __global uchar* changedTiles, __global uchar* activeTiles, __global uchar* nextChangedTiles)
+{
+    int tileX = get_global_id(0);
+    int tileY = get_global_id(1);
+    if (tileX >= ACTIVITY_TILES_X || tileY >= ACTIVITY_TILES_Y)
+        return;
 
-    cellTypes[i] = readCells[i];
-    float4 color = readColors[i];
+    uchar active = 0;
+    for (int y = max(tileY - 1, 0); y <= min(tileY + 1, ACTIVITY_TILES_Y - 1); y++)
+    {
+        for (int x = max(tileX - 1, 0); x <= min(tileX + 1, ACTIVITY_TILES_X - 1); x++)
+            active |= changedTiles[y * ACTIVITY_TILES_X + x];
+    }
+
+    int tile = tileY * ACTIVITY_TILES_X + tileX;
+    activeTiles[tile] = active;
+    nextChangedTiles[tile] = 0;
+}
 
-    int index = indexes[i % *numberOfCellsPerPartition];
-    int neighbor = i + neighbors[index];
+// Direct variants, one work-item per cell of the padded grid reading its neighbors in global memory at constant offsets
+__kernel void resolve_cells(int numberOfCellInX, int numberOfCellInY, int rowsPerPartition,
+    __global uchar* readStates, __global uchar* activeTiles, __global uchar* resolvedCells)
+{
+    int i = get_global_id(0);
+    int x = i % STRIDE;
+    int row = i / STRIDE;
+    if (!activeTiles[get_activity_tile(x, row, CELLS_X)] || !is_cell(x, row, CELLS_X, CELLS_Y, PARTITION_ROWS))
+        return;
 
-    if (readCells[i] == 1)
+    int type = get_type(readStates[i]);
+    int resolved = type;
+    if (type == CELL_HEALTHY || type == CELL_CANCER)
     {
+        int target = type == CELL_HEALTHY ? CELL_CANCER : CELL_MEDECINE;
+        int threshold = type == CELL_HEALTHY ? CANCER_THRESHOLD : CURE_THRESHOLD;
         int count = 0;
-        while (neighbors[index] != 0)
+        for (int j = 0; j < 8; j++)
         {
-            int neighbor = i + neighbors[index++];
-            if (readCells[neighbor] == 0)
+            if (get_type(readStates[i + NeighborOffsetY[j] * STRIDE + NeighborOffsetX[j]]) == target)
                 count++;
         }
 
-        if (count >= 6)
+        if (count >= threshold)
+            resolved = type == CELL_HEALTHY ? CELL_CANCER : CELL_CURED;
+    }
+    resolvedCells[i] = resolved;
+}
+
+// Ghosts are never cured
+bool is_consumed(int i, int numberOfCellInX, __global uchar* resolvedCells)
+{
+    for (int j = 0; j < 8; j++)
+    {
+        if (resolvedCells[i + NeighborOffsetY[j] * STRIDE + NeighborOffsetX[j]] == CELL_CURED)
+            return true;
+    }
+    return false;
+}
+
+__kernel void advance_cells(int numberOfCellInX, int numberOfCellInY, int rowsPerPartition,
+    __global uchar* readStates, __global uchar* resolvedCells, __global uchar* activeTiles, __global uchar* cellStates,
+    __global uchar* changedTiles)
+{
+    int i = get_global_id(0);
+    int x = i % STRIDE;
+    int row = i / STRIDE;
+    int activityTile = get_activity_tile(x, row, CELLS_X);
+    if (!activeTiles[activityTile] || !is_cell(x, row, CELLS_X, CELLS_Y, PARTITION_ROWS))
+        return;
+
+    // Healthy and cancer update, medecine next to a cured cell is consumed
+    uchar state = readStates[i];
+    int resolved = resolvedCells[i];
+    bool medecine = resolved == CELL_MEDECINE;
+    int type = resolved == CELL_CURED ? CELL_HEALTHY : resolved;
+    if (medecine && is_consumed(i, CELLS_X, resolvedCells))
+    {
+        type = CELL_HEALTHY;
+        medecine = false;
+    }
+    bool occupied = type == CELL_MEDECINE;
+
+    // Medecine restores the cell it was covering before moving on
+    if (medecine)
+        type = get_previous_type(state);
+
+    // Medecine moving into this cell, the first neighbor in offset order wins, the ghosts are never medecine
+    uchar nextState = (uchar)type;
+    for (int j = 0; j < 8 && !occupied; j++)
+    {
+        int source = get_source_row(row, j, CELLS_Y, PARTITION_ROWS) * STRIDE + x - NeighborOffsetX[j];
+        uchar sourceState = readStates[source];
+        if (get_type(sourceState) == CELL_MEDECINE && get_direction(sourceState) == j && !is_consumed(source, CELLS_X, resolvedCells))
         {
-            cellTypes[i] = 0;
-            color = (float4)(0.75f, 0.0f, 0.0f, 1.0f);
+            nextState = pack_medecine(type, j);
+            break;
         }
     }
-    else if (readCells[i] == 0)
+
+    // Every work-item of a changed tile writes the same flag
+    if (nextState != state)
+        changedTiles[activityTile] = 1;
+    cellStates[i] = nextState;
+}
+
+// Work-group tiled variants, the tile and its halo are staged in local memory once instead of reading every neighbor in global memory
+void load_tile(__global uchar* cells, __local uchar* tile, int halo, int numberOfCellInX, int numberOfCellInY, int rowsPerPartition)
+{
+    int tileX = get_local_size(0) + 2 * halo;
+    int tileY = get_local_size(1) + 2 * halo;
+    int originX = get_group_id(0) * get_local_size(0) - halo;
+    int originY = get_group_id(1) * get_local_size(1) - halo;
+    int localIndex = get_local_id(1) * get_local_size(0) + get_local_id(0);
+    int localSize = get_local_size(0) * get_local_size(1);
+
+    // Past the padded grid the halo is only read by ghosts, it holds the border like the ring
+    for (int t = localIndex; t < tileX * tileY; t += localSize)
     {
+        int x = originX + t % tileX;
+        int y = originY + t / tileX;
+        tile[t] = (x >= 0 && x < STRIDE && y >= 0 && y < PADDED_ROWS) ? cells[y * STRIDE + x] : BORDER_CELL;
+    }
+}
+
+// A whole work-group is in the same activity tile, it skips before reaching the barrier
+bool is_group_active(__global uchar* activeTiles, int numberOfCellInX)
+{
+    return activeTiles[get_activity_tile(get_group_id(0) * get_local_size(0), get_group_id(1) * get_local_size(1), CELLS_X)] != 0;
+}
+
+__kernel void resolve_cells_tiled(int numberOfCellInX, int numberOfCellInY, int rowsPerPartition,
+    __global uchar* readStates, __global uchar* activeTiles, __global uchar* resolvedCells, __local uchar* tile)
+{
+    if (!is_group_active(activeTiles, CELLS_X))
+        return;
+
+    load_tile(readStates, tile, 1, CELLS_X, CELLS_Y, PARTITION_ROWS);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int x = get_global_id(0);
+    int row = get_global_id(1);
+    if (!is_cell(x, row, CELLS_X, CELLS_Y, PARTITION_ROWS))
+        return;
+
+    int tileX = get_local_size(0) + 2;
+    int center = (get_local_id(1) + 1) * tileX + get_local_id(0) + 1;
+    int type = get_type(tile[center]);
+
+    int resolved = type;
+    if (type == CELL_HEALTHY || type == CELL_CANCER)
+    {
+        int target = type == CELL_HEALTHY ? CELL_CANCER : CELL_MEDECINE;
+        int threshold = type == CELL_HEALTHY ? CANCER_THRESHOLD : CURE_THRESHOLD;
         int count = 0;
-        int medecines[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
-        while (neighbors[index] != 0)
+        for (int j = 0; j < 8; j++)
         {
-            int neighbor = i + neighbors[index++];;
-            if (readCells[neighbor] == 2)
-                medecines[count++] = neighbor;
+            if (get_type(tile[center + NeighborOffsetY[j] * tileX + NeighborOffsetX[j]]) == target)
+                count++;
         }
 
-        if (count >= 6)
-        {
-            cellTypes[i] = 1;
-            color = (float4)(0.0f, 1.0f, 0.0f, 1.0f);
-
-            for (int j = 0; j < 8; j++)
-            {
-                if (medecines[j] >= 0)
-                    updatedCells[medecines[j]] = 1;
-            }
-        }
+        if (count >= threshold)
+            resolved = type == CELL_HEALTHY ? CELL_CANCER : CELL_CURED;
     }
-    vstore4(color, i, cellColor);
+    resolvedCells[row * STRIDE + x] = resolved;
 }
 
-__kernel void update_neighbor_cancer_cells(__global int* readCells, __global float4* readColors,
-    __global int* cellTypes, __global float* cellColor,
-    __global int* updatedCells,
-    __global MedecineCell* readMedecineCells, __global MedecineCell* medecineCells)
+bool is_consumed_tiled(__local uchar* resolvedTile, int center, int tileX)
 {
-    int i = get_global_id(0);
+    for (int j = 0; j < 8; j++)
+    {
+        if (resolvedTile[center + NeighborOffsetY[j] * tileX + NeighborOffsetX[j]] == CELL_CURED)
+            return true;
+    }
+    return false;
+}
+
+// A source is up to two rows away across a seam, and whether it is consumed depends on the cells around it
+__kernel void advance_cells_tiled(int numberOfCellInX, int numberOfCellInY, int rowsPerPartition,
+    __global uchar* readStates, __global uchar* resolvedCells, __global uchar* activeTiles, __global uchar* cellStates,
+    __global uchar* changedTiles, __local uchar* stateTile, __local uchar* resolvedTile)
+{
+    if (!is_group_active(activeTiles, CELLS_X))
+        return;
+
+    load_tile(readStates, stateTile, 2, CELLS_X, CELLS_Y, PARTITION_ROWS);
+    load_tile(resolvedCells, resolvedTile, 3, CELLS_X, CELLS_Y, PARTITION_ROWS);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int x = get_global_id(0);
+    int row = get_global_id(1);
+    if (!is_cell(x, row, CELLS_X, CELLS_Y, PARTITION_ROWS))
+        return;
 
-    cellTypes[i] = readCells[i];
-    float4 color = readColors[i];
+    int stateTileX = get_local_size(0) + 4;
+    int resolvedTileX = get_local_size(0) + 6;
+    int stateCenter = (get_local_id(1) + 2) * stateTileX + get_local_id(0) + 2;
+    int resolvedCenter = (get_local_id(1) + 3) * resolvedTileX + get_local_id(0) + 3;
 
-    medecineCells[i] = readMedecineCells[i];
-    if (updatedCells[i] == 1)
+    // Healthy and cancer update, medecine next to a cured cell is consumed
+    uchar state = stateTile[stateCenter];
+    int resolved = resolvedTile[resolvedCenter];
+    bool medecine = resolved == CELL_MEDECINE;
+    int type = resolved == CELL_CURED ? CELL_HEALTHY : resolved;
+    if (medecine && is_consumed_tiled(resolvedTile, resolvedCenter, resolvedTileX))
     {
-        cellTypes[i] = 1;
-        color = (float4)(0.0f, 1.0f, 0.0f, 1.0f);
-        medecineCells[i].Valid = 0;
+        type = CELL_HEALTHY;
+        medecine = false;
+    }
+    bool occupied = type == CELL_MEDECINE;
+
+    // Medecine restores the cell it was covering before moving on
+    if (medecine)
+        type = get_previous_type(state);
+
+    // Medecine moving into this cell, the first neighbor in offset order wins, the ghosts are never medecine
+    uchar nextState = (uchar)type;
+    for (int j = 0; j < 8 && !occupied; j++)
+    {
+        int sourceRows = get_source_row(row, j, CELLS_Y, PARTITION_ROWS) - row;
+        uchar sourceState = stateTile[stateCenter + sourceRows * stateTileX - NeighborOffsetX[j]];
+        int sourceCenter = resolvedCenter + sourceRows * resolvedTileX - NeighborOffsetX[j];
+        if (get_type(sourceState) == CELL_MEDECINE && get_direction(sourceState) == j
+            && !is_consumed_tiled(resolvedTile, sourceCenter, resolvedTileX))
+        {
+            nextState = pack_medecine(type, j);
+            break;
+        }
     }
-    vstore4(color, i, cellColor);
+
+    if (nextState != state)
+        changedTiles[get_activity_tile(x, row, CELLS_X)] = 1;
+    cellStates[row * STRIDE + x] = nextState;
 }
 
-__kernel void update_medecine_cells(int numberOfCellInX, int numberOfCellInY,
-    __global int* readCells, __global float4* readColors,
-    __global int* cellTypes, __global float* cellColor,
-    __global MedecineCell* readMedecineCells, __global float4* readMedecineColors,
-    __global MedecineCell* medecineCells, __global float* medecineColors)
+// Only the cells are counted, the ghosts are skipped
+// Split 64-bit counter, the addition that wraps the low word around carries into the high word
+void add_count(volatile __global uint* low, volatile __global uint* high, uint value)
 {
-    int i = get_global_id(0);
+    uint previous = atomic_add(low, value);
+    if (previous + value < previous)
+        atomic_inc(high);
+}
+
+__kernel void count_cells(int numberOfCellInX, int numberOfCellInY, int rowsPerPartition, __global uchar* readStates,
+    __global uint* result, __local uint* localCounts)
+{
+    int localIndex = get_local_id(0);
+    int localSize = get_local_size(0);
+
+    uint cancer = 0;
+    uint healthy = 0;
+    uint medecine = 0;
+    for (int i = get_global_id(0); i < CELLS; i += get_global_size(0))
+    {
+        int type = get_type(readStates[get_padded_index(i % CELLS_X, i / CELLS_X, CELLS_X, PARTITION_ROWS)]);
+        cancer += type == CELL_CANCER;
+        healthy += type == CELL_HEALTHY;
+        medecine += type == CELL_MEDECINE;
+    }
 
-    cellTypes[i] = readCells[i];
-    float4 color = readColors[i];
+    localCounts[localIndex] = cancer;
+    localCounts[localSize + localIndex] = healthy;
+    localCounts[2 * localSize + localIndex] = medecine;
+    barrier(CLK_LOCAL_MEM_FENCE);
 
-    if (readMedecineCells[i].Valid > 0)
+    // Tree reduction of the work-group, the local size is a power of two
+    for (int stride = localSize / 2; stride > 0; stride >>= 1)
     {
-        cellTypes[i] = readMedecineCells[i].PreviousType;
-        color = readMedecineColors[i];
-        int yOffset = readMedecineCells[i].Offset / (numberOfCellInX - 1);
-        int xOffset = readMedecineCells[i].Offset - (yOffset * numberOfCellInX);
-        int y = (i / numberOfCellInX) + yOffset;
-        int x = (i % numberOfCellInX) + xOffset;
-        if (x >= 0 && x < numberOfCellInX && y >= 0 && y < numberOfCellInY)
+        if (localIndex < stride)
         {
-            if (readCells[i + readMedecineCells[i].Offset] != 2)
-            {
-                medecineCells[i + readMedecineCells[i].Offset].Valid = 1;
-                medecineCells[i + readMedecineCells[i].Offset].Offset = readMedecineCells[i].Offset;
-            }
+            localCounts[localIndex] += localCounts[localIndex + stride];
+            localCounts[localSize + localIndex] += localCounts[localSize + localIndex + stride];
+            localCounts[2 * localSize + localIndex] += localCounts[2 * localSize + localIndex + stride];
         }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (localIndex == 0)
+    {
+        add_count(&result[0], &result[3], localCounts[0]);
+        add_count(&result[1], &result[4], localCounts[localSize]);
+        add_count(&result[2], &result[5], localCounts[2 * localSize]);
     }
-    vstore4(color, i, cellColor);
 }
 
-__kernel void move_medecine_cells(__global int* readCells, __global float4* readColors,
-    __global int* cellTypes, __global float* cellColor,
-    __global MedecineCell* readMedecineCells,
-    __global MedecineCell* medecineCells, __global float* medecineColors)
+// Injections only cover the neighbors inside the partition of their cell, like the native backends
+bool in_partition(int x, int y, int j, int numberOfCellInX, int numberOfCellInY, int rowsPerPartition)
 {
-    int i = get_global_id(0);
+    int neighborX = x + NeighborOffsetX[j];
+    int neighborY = y + NeighborOffsetY[j];
+    return neighborX >= 0 && neighborX < CELLS_X && neighborY >= 0 && neighborY < CELLS_Y
+        && neighborY / PARTITION_ROWS == y / PARTITION_ROWS;
+}
+
+// Number of cells an injection covers, drawn between 1 and 8 from its seed when it is not given, it has to match getNumberOfInjectedCells
+int get_injected_cells(int4 record)
+{
+    if (record.y > 0)
+        return record.y;
 
-    cellTypes[i] = readCells[i];
-    float4 color = readColors[i];
+    uint hash = (uint)record.z;
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352Du;
+    hash ^= hash >> 15;
+    hash *= 0x846CA68Bu;
+    hash ^= hash >> 16;
+    return 1 + (int)(hash % 8);
+}
 
-    if (readMedecineCells[i].Valid > 0)
+// An injection covers the first cells - 1 neighbors of its cell inside the partition, in direction order
+bool injection_covers(int4 record, int cell, int numberOfCellInX, int numberOfCellInY, int rowsPerPartition)
+{
+    int x = record.x % CELLS_X;
+    int y = record.x / CELLS_X;
+    int remaining = get_injected_cells(record) - 1;
+    for (int j = 0; j < 8 && remaining > 0; j++)
     {
-        medecineCells[i].Valid = 1;
-        medecineCells[i].PreviousType = readCells[i];
-        medecineCells[i].Offset = readMedecineCells[i].Offset;
-        vstore4(color, i, medecineColors);
-
-        cellTypes[i] = 2;
-        color = (float4)(1.0f, 1.0f, 0.0f, 1.0f);
+        if (!in_partition(x, y, j, CELLS_X, CELLS_Y, PARTITION_ROWS))
+            continue;
+        if ((y + NeighborOffsetY[j]) * CELLS_X + x + NeighborOffsetX[j] == cell)
+            return true;
+        remaining--;
     }
-    vstore4(color, i, cellColor);
+    return false;
 }
 
-__kernel void count_cells(__global int* readCells, __global int* result, int numberOfCell, int numberOfPartitions)
+// One work-item per record of (cell, number of cells, seed), applied to the generation about to be stepped
+// Records behave as if applied in order, a cell covered by several of them is only written by the first one
+__kernel void inject_medecine(int numberOfCellInX, int numberOfCellInY, int rowsPerPartition, int numberOfRecords,
+    __global const int4* records, __global uchar* cellStates, __global uchar* changedTiles)
 {
-    int i = get_global_id(0);
-    int startIndex = (numberOfCell / numberOfPartitions) * i;
-    int endIndex = (numberOfCell / numberOfPartitions) * (i + 1);
-    int outputIndex = i * 3;
-
-    result[outputIndex] = 0;
-    result[outputIndex + 1] = 0;
-    result[outputIndex + 2] = 0;
-    for (int j = startIndex; j < endIndex; j++)
+    int r = get_global_id(0);
+    if (r >= numberOfRecords)
+        return;
+
+    int4 record = records[r];
+    int x = record.x % CELLS_X;
+    int y = record.x / CELLS_X;
+    int remaining = get_injected_cells(record) - 1;
+    for (int j = 0; j < 8 && remaining > 0; j++)
     {
-        switch (readCells[j])
-        {
-        case 0:
-            ++result[outputIndex];
-            break;
-        case 1:
-            ++result[outputIndex + 1];
-            break;
-        case 2:
-            ++result[outputIndex + 2];
-            break;
-        }
+        if (!in_partition(x, y, j, CELLS_X, CELLS_Y, PARTITION_ROWS))
+            continue;
+        remaining--;
+
+        int neighborX = x + NeighborOffsetX[j];
+        int neighborY = y + NeighborOffsetY[j];
+        int neighbor = neighborY * CELLS_X + neighborX;
+        bool taken = false;
+        for (int k = 0; k < r && !taken; k++)
+            taken = injection_covers(records[k], neighbor, CELLS_X, CELLS_Y, PARTITION_ROWS);
+
+        int padded = get_padded_index(neighborX, neighborY, CELLS_X, PARTITION_ROWS);
+        uchar state = cellStates[padded];
+        if (taken || get_type(state) == CELL_MEDECINE)
+            continue;
+
+        cellStates[padded] = pack_medecine(get_type(state), j);
+        changedTiles[get_activity_tile(neighborX + 1, get_padded_row(neighborY, PARTITION_ROWS), CELLS_X)] = 1;
     }
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "ActivityMap.h"
+
+#include <algorithm>
+
+ActivityMap::ActivityMap(size_t numberOfCellInX, size_t numberOfCellInY, size_t tileWidth, size_t tileHeight) :
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCellY(numberOfCellInY),
+    m_TileWidth(std::max(tileWidth, (size_t)3)),
+    m_TileHeight(std::max(tileHeight, (size_t)3)),
+    m_NumberOfTileX((numberOfCellInX + m_TileWidth - 1) / m_TileWidth),
+    m_NumberOfTileY((numberOfCellInY + m_TileHeight - 1) / m_TileHeight)
+{
+    // Nothing has been stepped yet, every tile starts active
+    m_Changed.assign(getNumberOfTiles(), 1);
+    m_ActiveTiles.reserve(getNumberOfTiles());
+}
+
+TileBounds ActivityMap::getTileBounds(size_t tile) const
+{
+    size_t tileX = tile % m_NumberOfTileX;
+    size_t tileY = tile / m_NumberOfTileX;
+    return { tileX * m_TileWidth, std::min((tileX + 1) * m_TileWidth, m_NumberOfCellX),
+        tileY * m_TileHeight, std::min((tileY + 1) * m_TileHeight, m_NumberOfCellY) };
+}
+
+void ActivityMap::markAll()
+{
+    std::fill(m_Changed.begin(), m_Changed.end(), (uint8_t)1);
+}
+
+void ActivityMap::update()
+{
+    m_ActiveTiles.clear();
+    for (size_t tileY = 0; tileY < m_NumberOfTileY; tileY++)
+    {
+        size_t firstY = tileY > 0 ? tileY - 1 : 0;
+        size_t lastY = std::min(tileY + 1, m_NumberOfTileY - 1);
+        for (size_t tileX = 0; tileX < m_NumberOfTileX; tileX++)
+        {
+            if (!m_Enabled)
+            {
+                m_ActiveTiles.push_back(tileY * m_NumberOfTileX + tileX);
+                continue;
+            }
+
+            size_t firstX = tileX > 0 ? tileX - 1 : 0;
+            size_t lastX = std::min(tileX + 1, m_NumberOfTileX - 1);
+            bool active = false;
+            for (size_t y = firstY; y <= lastY && !active; y++)
+            {
+                for (size_t x = firstX; x <= lastX && !active; x++)
+                    active = m_Changed[y * m_NumberOfTileX + x] != 0;
+            }
+            if (active)
+                m_ActiveTiles.push_back(tileY * m_NumberOfTileX + tileX);
+        }
+    }
+    std::fill(m_Changed.begin(), m_Changed.end(), (uint8_t)0);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rectangle of cells covered by a tile, the tiles on the right and bottom borders may be smaller
+struct TileBounds
+{
+    size_t BeginX;
+    size_t EndX;
+    size_t BeginY;
+    size_t EndY;
+};
+
+// Tiles whose cells changed during the last generation, a tile is only stepped again when it or one of its neighbors changed
+// A cell depends on the cells up to three away through the resolve, consume and advance passes, so tiles are at least three cells wide
+// Tiles that are not stepped keep their previous results, which are still those of the unchanged cells around them
+class ActivityMap
+{
+private:
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCellY;
+    const size_t m_TileWidth;
+    const size_t m_TileHeight;
+    const size_t m_NumberOfTileX;
+    const size_t m_NumberOfTileY;
+
+    // Written by the tasks stepping a tile, each marks only its own tile
+    std::vector<uint8_t> m_Changed;
+    std::vector<size_t> m_ActiveTiles;
+    // Every tile is stepped when disabled, the changes are still marked for when it is enabled again
+    bool m_Enabled = true;
+
+public:
+    ActivityMap(size_t numberOfCellInX, size_t numberOfCellInY, size_t tileWidth, size_t tileHeight);
+
+    size_t getNumberOfTiles() const { return m_NumberOfTileX * m_NumberOfTileY; }
+    size_t getTile(size_t x, size_t y) const { return y / m_TileHeight * m_NumberOfTileX + x / m_TileWidth; }
+    TileBounds getTileBounds(size_t tile) const;
+
+    void markTile(size_t tile) { m_Changed[tile] = 1; }
+    void markCell(size_t x, size_t y) { m_Changed[getTile(x, y)] = 1; }
+    void markAll();
+
+    void setEnabled(bool enabled) { m_Enabled = enabled; }
+    bool isEnabled() const { return m_Enabled; }
+
+    // Lists the tiles to step from the changes since the last update and clears them
+    void update();
+    const std::vector<size_t>& getActiveTiles() const { return m_ActiveTiles; }
+};
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+
+// Fixed size heap array whose storage is aligned for DMA transfers and mapping, sized at runtime
+template<typename T>
+class AlignedArray
+{
+private:
+    T* m_Data = nullptr;
+    size_t m_Size = 0;
+
+    static_assert(std::is_trivially_destructible<T>::value, "AlignedArray only holds plain data");
+
+public:
+    static constexpr size_t Alignment = 4096;
+
+public:
+    AlignedArray() = default;
+
+    explicit AlignedArray(size_t size)
+    {
+        allocate(size);
+    }
+
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+
+    AlignedArray(AlignedArray&& other) noexcept
+        : m_Data(other.m_Data), m_Size(other.m_Size)
+    {
+        other.m_Data = nullptr;
+        other.m_Size = 0;
+    }
+
+    AlignedArray& operator=(AlignedArray&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_Data = other.m_Data;
+            m_Size = other.m_Size;
+            other.m_Data = nullptr;
+            other.m_Size = 0;
+        }
+        return *this;
+    }
+
+    ~AlignedArray()
+    {
+        release();
+    }
+
+    void allocate(size_t size)
+    {
+        release();
+        if (size == 0)
+            return;
+
+        size_t bytes = (size * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+#ifdef _WIN32
+        m_Data = (T*)_aligned_malloc(bytes, Alignment);
+#else
+        m_Data = (T*)aligned_alloc(Alignment, bytes);
+#endif
+        if (!m_Data)
+            throw std::bad_alloc();
+
+        m_Size = size;
+        for (size_t i = 0; i < m_Size; i++)
+            new (m_Data + i) T();
+    }
+
+    void release()
+    {
+        if (!m_Data)
+            return;
+
+#ifdef _WIN32
+        _aligned_free(m_Data);
+#else
+        free(m_Data);
+#endif
+        m_Data = nullptr;
+        m_Size = 0;
+    }
+
+    T* data() { return m_Data; }
+    const T* data() const { return m_Data; }
+    size_t size() const { return m_Size; }
+
+    T& operator[](size_t index) { return m_Data[index]; }
+    const T& operator[](size_t index) const { return m_Data[index]; }
+};
\ No newline at end of file
@@ -1,15 +1,49 @@
 #include "CellGrowthScene.h"
+#include "SimulationLog.h"
 
 class Application : public Elysium::Application
 {
 private:
     bool m_VSync = false;
+    int m_GridSize[2];
+
+    // The entry after the backends leaves the cross-check off
+    static constexpr const char* s_Backends[] = { "opencl", "cpu", "bitboard", "mapped", "reference", "off" };
+    static constexpr int s_NumberOfBackends = 5;
+    BackendSettings m_Settings;
+    int m_Backend = 0;
+    int m_CrossCheck = s_NumberOfBackends;
+    char m_Device[64] = {};
+
+private:
+    static int findBackend(const std::string& name)
+    {
+        for (int i = 0; i < s_NumberOfBackends; i++)
+        {
+            if (name == s_Backends[i])
+                return i;
+        }
+        return s_NumberOfBackends;
+    }
 
 public:
-    Application(const std::string& title) : Elysium::Application(title)
+    Application(const std::string& title, size_t numberOfCellInX, size_t numberOfCellInY, const BackendSettings& settings) : Elysium::Application(title),
+        m_Settings(settings)
     {
+        m_GridSize[0] = (int)numberOfCellInX;
+        m_GridSize[1] = (int)numberOfCellInY;
+        m_Backend = findBackend(m_Settings.Backend);
+        if (m_Backend == s_NumberOfBackends)
+        {
+            // Same fallback as when the backends are created, the combo then shows the backend that runs
+            SIM_WARN("Unknown simulation backend: {0}, using cpu", m_Settings.Backend);
+            m_Backend = findBackend("cpu");
+            m_Settings.Backend = s_Backends[m_Backend];
+        }
+        m_CrossCheck = findBackend(m_Settings.CrossCheck);
+        strncpy(m_Device, m_Settings.Device.c_str(), sizeof(m_Device) - 1);
         m_Window->setVSync(m_VSync);
-        m_SceneManager.loadScene(new CellGrowthScene(m_Window->getWidth(), m_Window->getHeight()));
+        m_SceneManager.loadScene(new CellGrowthScene(m_Window->getWidth(), m_Window->getHeight(), numberOfCellInX, numberOfCellInY, m_Settings));
     }
 
     ~Application()
@@ -21,10 +55,20 @@ public:
         ImGui::Begin("Main Application");
         ImGui::Checkbox("VSync", &m_VSync);
         ImGui::ColorEdit4("Clear Color", m_ClearColor);
+        ImGui::InputInt2("Grid Size", m_GridSize);
+        ImGui::Combo("Backend", &m_Backend, s_Backends, s_NumberOfBackends);
+        ImGui::Combo("Cross-Check", &m_CrossCheck, s_Backends, s_NumberOfBackends + 1);
+        ImGui::InputText("OpenCL Device", m_Device, sizeof(m_Device));
+        ImGui::Checkbox("Profile Stages", &m_Settings.Profiling);
         if (ImGui::Button("Generate New Grid"))
         {
+            m_GridSize[0] = std::max(m_GridSize[0], 1);
+            m_GridSize[1] = std::max(m_GridSize[1], 1);
+            m_Settings.Backend = s_Backends[m_Backend];
+            m_Settings.CrossCheck = m_CrossCheck < s_NumberOfBackends ? s_Backends[m_CrossCheck] : "";
+            m_Settings.Device = m_Device;
             m_SceneManager.unloadScene();
-            m_SceneManager.loadScene(new CellGrowthScene(m_Window->getWidth(), m_Window->getHeight()));
+            m_SceneManager.loadScene(new CellGrowthScene(m_Window->getWidth(), m_Window->getHeight(), (size_t)m_GridSize[0], (size_t)m_GridSize[1], m_Settings));
         }
         ImGui::End();
 
@@ -32,9 +76,56 @@ public:
     }
 };
 
-int main(void)
+constexpr const char* Application::s_Backends[];
+constexpr int Application::s_NumberOfBackends;
+
+// Usage: Cell-Growth [--profile] [--backend opencl|cpu|bitboard|mapped|reference] [--device gpu|cpu|any|index] [--cross-check backend]
+//     [--mapped-file path] [--resident-mb megabytes] [--border empty|cancer] [cells in x] [cells in y]
+int main(int argc, char** argv)
 {
-    Application* application = new Application("Cell Growth");
+    size_t numberOfCellInX = CellArea::DefaultNumberOfCell_X;
+    size_t numberOfCellInY = CellArea::DefaultNumberOfCell_Y;
+    BackendSettings settings;
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--profile") == 0)
+            settings.Profiling = true;
+        else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc)
+            settings.Backend = argv[++i];
+        else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+            settings.Device = argv[++i];
+        else if (strcmp(argv[i], "--cross-check") == 0 && i + 1 < argc)
+            settings.CrossCheck = argv[++i];
+        else if (strcmp(argv[i], "--mapped-file") == 0 && i + 1 < argc)
+            settings.MappedFile = argv[++i];
+        else if (strcmp(argv[i], "--resident-mb") == 0 && i + 1 < argc)
+            settings.ResidentMegabytes = (size_t)std::max(atoll(argv[++i]), 1LL);
+        else if (strcmp(argv[i], "--border") == 0 && i + 1 < argc)
+        {
+            // Anything else keeps the grid surrounded by empty cells
+            parseBorderFill(argv[++i], settings.Border);
+        }
+        else
+            sizes.push_back((size_t)std::max(atoll(argv[i]), 1LL));
+    }
+    if (sizes.size() > 0)
+        numberOfCellInX = numberOfCellInY = sizes[0];
+    if (sizes.size() > 1)
+        numberOfCellInY = sizes[1];
+
+    // The simulation core logs through the engine once it is running
+    SimulationLog::setSink([](LogLevel level, const std::string& message)
+    {
+        if (level == LogLevel::Error)
+            ELY_ERROR("{0}", message);
+        else if (level == LogLevel::Warning)
+            ELY_WARN("{0}", message);
+        else
+            ELY_INFO("{0}", message);
+    });
+
+    Application* application = new Application("Cell Growth", numberOfCellInX, numberOfCellInY, settings);
     application->Run();
     delete application;
     return 0;
@@ -0,0 +1,555 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+
+#include "AlignedArray.h"
+#include "Simulation.h"
+#include "SimulationLog.h"
+#include "StageProfiler.h"
+
+namespace {
+
+struct Timing
+{
+    std::string Name;
+    size_t Samples = 0;
+    double AverageMs = 0.0;
+    double MedianMs = 0.0;
+    double P99Ms = 0.0;
+    double MinMs = 0.0;
+};
+
+struct Result
+{
+    // The backend that ran, a requested backend that is not available falls back to another one
+    // Results are compared against the baseline by the backend that ran so that a fallback is never taken for the requested one
+    std::string Backend;
+    std::string Requested;
+    size_t NumberOfCellX;
+    size_t NumberOfCellY;
+    double CancerDensity;
+    double GenerationsPerSecond = 0.0;
+    double McellsPerSecond = 0.0;
+    std::vector<Timing> Timings;
+    // Passes timed by the backend itself, on the host or on the device
+    std::vector<StageProfiler::StageStats> Stages;
+};
+
+struct Options
+{
+    std::vector<std::string> Backends = { "opencl", "cpu", "bitboard" };
+    std::vector<std::pair<size_t, size_t>> Sizes = { { 256, 256 }, { 512, 512 }, { 1024, 1024 }, { 2048, 2048 }, { 4096, 4096 }, { 8192, 8192 } };
+    std::vector<double> Densities = { 0.25, 0.5 };
+    BackendSettings Settings;
+    uint64_t Seed = 1;
+    size_t Warmup = 10;
+    size_t Generations = 100;
+    // Batches of injections and readbacks timed after the generations
+    size_t Repetitions = 16;
+    size_t InjectionsPerBatch = 64;
+};
+
+Timing summarize(const std::string& name, std::vector<double> durations)
+{
+    Timing timing;
+    timing.Name = name;
+    timing.Samples = durations.size();
+    if (durations.empty())
+        return timing;
+
+    std::sort(durations.begin(), durations.end());
+    double total = 0.0;
+    for (double duration : durations)
+        total += duration;
+    timing.AverageMs = total / durations.size();
+    timing.MedianMs = durations[durations.size() / 2];
+    timing.P99Ms = durations[std::min(durations.size() - 1, durations.size() * 99 / 100)];
+    timing.MinMs = durations[0];
+    return timing;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+Result run(const Options& options, const std::string& backend, size_t numberOfCellInX, size_t numberOfCellInY, double cancerDensity)
+{
+    BackendSettings settings = options.Settings;
+    settings.Backend = backend;
+    settings.Profiling = true;
+    Simulation simulation(numberOfCellInX, numberOfCellInY, settings, options.Seed, cancerDensity);
+    // Once the grid settles most tiles are skipped, every one is stepped so that whole generations are timed
+    simulation.setActivityTracking(false);
+
+    Result result;
+    result.Backend = simulation.getBackendName();
+    result.Requested = backend;
+    result.NumberOfCellX = simulation.NumberOfCellX;
+    result.NumberOfCellY = simulation.NumberOfCellY;
+    result.CancerDensity = cancerDensity;
+
+    for (size_t generation = 0; generation < options.Warmup; generation++)
+    {
+        simulation.step();
+        simulation.finish();
+    }
+    StageProfiler* profiler = simulation.getProfiler();
+    if (profiler)
+        profiler->reset();
+
+    // A generation is timed until it is counted and readable on the host, as the application and the headless runner wait for it
+    std::vector<double> generations;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t generation = 0; generation < options.Generations; generation++)
+    {
+        auto generationStart = std::chrono::steady_clock::now();
+        simulation.step();
+        simulation.finish();
+        generations.push_back(millisecondsSince(generationStart));
+    }
+    double seconds = millisecondsSince(start) * 1e-3;
+    if (seconds > 0.0)
+    {
+        result.GenerationsPerSecond = (double)options.Generations / seconds;
+        result.McellsPerSecond = result.GenerationsPerSecond * (double)simulation.NumberOfCell * 1e-6;
+    }
+
+    // Injections land on random cells of the finished generation, a generation is stepped between batches so they keep landing on fresh cells
+    std::mt19937_64 engine(options.Seed);
+    std::vector<double> injections;
+    std::vector<double> readbacks;
+    AlignedArray<CellState> states(simulation.NumberOfCell);
+    for (size_t repetition = 0; repetition < options.Repetitions; repetition++)
+    {
+        std::vector<Injection> batch;
+        for (size_t i = 0; i < options.InjectionsPerBatch; i++)
+            batch.push_back({ (size_t)(engine() % simulation.NumberOfCell), 8 });
+
+        // Backends may only queue the injections, they are timed with the generation applying them
+        // The injection pass alone is the Inject stage of the backend
+        auto injectionStart = std::chrono::steady_clock::now();
+        simulation.inject(batch);
+        simulation.step();
+        simulation.finish();
+        injections.push_back(millisecondsSince(injectionStart));
+
+        auto readbackStart = std::chrono::steady_clock::now();
+        simulation.exportStates(states.data());
+        readbacks.push_back(millisecondsSince(readbackStart));
+    }
+
+    // The stages include the injection passes, timed on their own by the backend
+    if (profiler)
+        result.Stages = profiler->getStats();
+
+    result.Timings.push_back(summarize("generation", generations));
+    result.Timings.push_back(summarize("inject+generation", injections));
+    result.Timings.push_back(summarize("readback", readbacks));
+    SIM_INFO("{0} {1}x{2} cancer {3}: {4} generations/s, {5} Mcells/s", result.Backend, result.NumberOfCellX, result.NumberOfCellY,
+        cancerDensity, result.GenerationsPerSecond, result.McellsPerSecond);
+    return result;
+}
+
+std::string escape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if ((unsigned char)c >= 0x20)
+            escaped += c;
+    }
+    return escaped;
+}
+
+std::string toJson(const Options& options, const std::vector<Result>& results)
+{
+    std::ostringstream json;
+    json.precision(6);
+    json << "{\n";
+    json << "  \"seed\": " << options.Seed << ",\n";
+    json << "  \"warmup\": " << options.Warmup << ",\n";
+    json << "  \"generations\": " << options.Generations << ",\n";
+    json << "  \"injectionsPerBatch\": " << options.InjectionsPerBatch << ",\n";
+    json << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& result = results[i];
+        json << (i > 0 ? ",\n" : "\n") << "    {\n";
+        json << "      \"backend\": \"" << escape(result.Backend) << "\",\n";
+        json << "      \"requested\": \"" << escape(result.Requested) << "\",\n";
+        json << "      \"cellsX\": " << result.NumberOfCellX << ",\n";
+        json << "      \"cellsY\": " << result.NumberOfCellY << ",\n";
+        json << "      \"cancerDensity\": " << result.CancerDensity << ",\n";
+        json << "      \"generationsPerSecond\": " << result.GenerationsPerSecond << ",\n";
+        json << "      \"mcellsPerSecond\": " << result.McellsPerSecond << ",\n";
+        json << "      \"timings\": {";
+        for (size_t j = 0; j < result.Timings.size(); j++)
+        {
+            const Timing& timing = result.Timings[j];
+            json << (j > 0 ? ",\n" : "\n") << "        \"" << escape(timing.Name) << "\": { \"averageMs\": " << timing.AverageMs
+                << ", \"medianMs\": " << timing.MedianMs << ", \"p99Ms\": " << timing.P99Ms << ", \"minMs\": " << timing.MinMs
+                << ", \"samples\": " << timing.Samples << " }";
+        }
+        json << "\n      },\n";
+        json << "      \"stages\": {";
+        for (size_t j = 0; j < result.Stages.size(); j++)
+        {
+            const StageProfiler::StageStats& stage = result.Stages[j];
+            json << (j > 0 ? ",\n" : "\n") << "        \"" << escape(stage.Name) << "\": { \"averageMs\": " << stage.AverageMs
+                << ", \"p99Ms\": " << stage.P99Ms << ", \"gbPerSecond\": " << stage.GBPerSecond << ", \"samples\": " << stage.Samples << " }";
+        }
+        json << (result.Stages.empty() ? "}\n" : "\n      }\n") << "    }";
+    }
+    json << "\n  ]\n}\n";
+    return json.str();
+}
+
+// Just enough JSON to read back the results written above
+struct JsonValue
+{
+    enum class Type { Null, Boolean, Number, String, Array, Object };
+
+    Type Kind = Type::Null;
+    double Number = 0.0;
+    std::string String;
+    std::vector<JsonValue> Items;
+    std::vector<std::pair<std::string, JsonValue>> Members;
+
+    const JsonValue* find(const std::string& key) const
+    {
+        for (const auto& member : Members)
+        {
+            if (member.first == key)
+                return &member.second;
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser
+{
+private:
+    const std::string& m_Text;
+    size_t m_Position = 0;
+
+private:
+    void skipSpaces()
+    {
+        while (m_Position < m_Text.size() && strchr(" \t\r\n", m_Text[m_Position]))
+            m_Position++;
+    }
+
+    bool consume(char c)
+    {
+        skipSpaces();
+        if (m_Position >= m_Text.size() || m_Text[m_Position] != c)
+            return false;
+        m_Position++;
+        return true;
+    }
+
+    bool parseString(std::string& string)
+    {
+        if (!consume('"'))
+            return false;
+        for (; m_Position < m_Text.size() && m_Text[m_Position] != '"'; m_Position++)
+        {
+            if (m_Text[m_Position] == '\\' && m_Position + 1 < m_Text.size())
+                m_Position++;
+            string += m_Text[m_Position];
+        }
+        return consume('"');
+    }
+
+public:
+    JsonParser(const std::string& text) : m_Text(text) {}
+
+    bool parse(JsonValue& value)
+    {
+        skipSpaces();
+        if (m_Position >= m_Text.size())
+            return false;
+
+        char c = m_Text[m_Position];
+        if (c == '{')
+        {
+            value.Kind = JsonValue::Type::Object;
+            m_Position++;
+            if (consume('}'))
+                return true;
+            do
+            {
+                std::pair<std::string, JsonValue> member;
+                if (!parseString(member.first) || !consume(':') || !parse(member.second))
+                    return false;
+                value.Members.push_back(std::move(member));
+            } while (consume(','));
+            return consume('}');
+        }
+        if (c == '[')
+        {
+            value.Kind = JsonValue::Type::Array;
+            m_Position++;
+            if (consume(']'))
+                return true;
+            do
+            {
+                value.Items.emplace_back();
+                if (!parse(value.Items.back()))
+                    return false;
+            } while (consume(','));
+            return consume(']');
+        }
+        if (c == '"')
+        {
+            value.Kind = JsonValue::Type::String;
+            return parseString(value.String);
+        }
+        for (const char* keyword : { "true", "false", "null" })
+        {
+            if (m_Text.compare(m_Position, strlen(keyword), keyword) == 0)
+            {
+                value.Kind = keyword[0] == 'n' ? JsonValue::Type::Null : JsonValue::Type::Boolean;
+                value.Number = keyword[0] == 't' ? 1.0 : 0.0;
+                m_Position += strlen(keyword);
+                return true;
+            }
+        }
+
+        char* end = nullptr;
+        value.Kind = JsonValue::Type::Number;
+        value.Number = strtod(m_Text.c_str() + m_Position, &end);
+        if (end == m_Text.c_str() + m_Position)
+            return false;
+        m_Position = end - m_Text.c_str();
+        return true;
+    }
+
+    bool parseDocument(JsonValue& value)
+    {
+        if (!parse(value))
+            return false;
+        skipSpaces();
+        return m_Position == m_Text.size();
+    }
+};
+
+bool loadJson(const std::string& path, JsonValue& root)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        SIM_ERROR("Cannot open benchmark results: {0}", path);
+        return false;
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+    std::string content = text.str();
+    if (!JsonParser(content).parseDocument(root) || !root.find("results"))
+    {
+        SIM_ERROR("Invalid benchmark results: {0}", path);
+        return false;
+    }
+    return true;
+}
+
+// Durations in milliseconds keyed by case and measure, medians for the timings and averages for the stages
+std::map<std::string, double> collectMetrics(const JsonValue& root)
+{
+    std::map<std::string, double> metrics;
+    const JsonValue* results = root.find("results");
+    if (!results)
+        return metrics;
+
+    for (const JsonValue& result : results->Items)
+    {
+        const JsonValue* backend = result.find("backend");
+        const JsonValue* cellsX = result.find("cellsX");
+        const JsonValue* cellsY = result.find("cellsY");
+        const JsonValue* density = result.find("cancerDensity");
+        if (!backend || !cellsX || !cellsY || !density)
+            continue;
+
+        char key[256];
+        snprintf(key, sizeof(key), "%s %.0fx%.0f cancer %g", backend->String.c_str(), cellsX->Number, cellsY->Number, density->Number);
+        for (const char* group : { "timings", "stages" })
+        {
+            const JsonValue* measures = result.find(group);
+            if (!measures)
+                continue;
+
+            for (const auto& measure : measures->Members)
+            {
+                const JsonValue* duration = measure.second.find(group[0] == 't' ? "medianMs" : "averageMs");
+                if (duration && duration->Kind == JsonValue::Type::Number)
+                    metrics[std::string(key) + " " + measure.first] = duration->Number;
+            }
+        }
+    }
+    return metrics;
+}
+
+// Returns the number of measures slower than the baseline by more than the tolerance
+size_t compare(const JsonValue& baseline, const JsonValue& current, double tolerance)
+{
+    // Durations this short are mostly timer noise, they are never flagged
+    constexpr double NoiseMs = 0.01;
+
+    std::map<std::string, double> baselineMetrics = collectMetrics(baseline);
+    std::map<std::string, double> currentMetrics = collectMetrics(current);
+    size_t numberOfRegressions = 0;
+    size_t numberOfCompared = 0;
+    for (const auto& metric : currentMetrics)
+    {
+        auto previous = baselineMetrics.find(metric.first);
+        if (previous == baselineMetrics.end())
+            continue;
+
+        numberOfCompared++;
+        double before = previous->second;
+        double after = metric.second;
+        double change = before > 0.0 ? after / before - 1.0 : 0.0;
+        if (after > before * (1.0 + tolerance) && after - before > NoiseMs)
+        {
+            numberOfRegressions++;
+            SIM_WARN("Regression {0}: {1} ms -> {2} ms (+{3}%)", metric.first, before, after, change * 100.0);
+        }
+        else if (after < before * (1.0 - tolerance) && before - after > NoiseMs)
+        {
+            SIM_INFO("Improvement {0}: {1} ms -> {2} ms ({3}%)", metric.first, before, after, change * 100.0);
+        }
+    }
+    SIM_INFO("Compared {0} measures, {1} regressions beyond {2}%", numberOfCompared, numberOfRegressions, tolerance * 100.0);
+    return numberOfRegressions;
+}
+
+template<typename T, typename Parse>
+std::vector<T> parseList(const char* text, Parse parse)
+{
+    std::vector<T> values;
+    std::string fields = text;
+    std::replace(fields.begin(), fields.end(), ',', ' ');
+    std::istringstream stream(fields);
+    std::string field;
+    while (stream >> field)
+        values.push_back(parse(field));
+    return values;
+}
+
+}
+
+// Usage: Cell-Growth-Benchmark [--backends opencl,cpu,bitboard,mapped,reference] [--sizes 256,1024,4096x2048] [--densities 0.25,0.5]
+//     [--generations n] [--warmup n] [--repetitions n] [--injections n] [--seed n] [--device gpu|cpu|any|index]
+//     [--mapped-file path] [--resident-mb megabytes] [--output file] [--results file] [--compare baseline] [--tolerance fraction]
+// Every backend is run on every size and density, the results are written as JSON to the output or the standard output
+// With --results the benchmarks are not run and the saved results are compared instead
+// Returns 2 when a measure is slower than in the baseline by more than the tolerance, 10% by default
+int main(int argc, char** argv)
+{
+    Options options;
+    options.Settings.Device = "gpu";
+    std::string outputPath;
+    std::string resultsPath;
+    std::string baselinePath;
+    double tolerance = 0.1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--backends") == 0 && i + 1 < argc)
+            options.Backends = parseList<std::string>(argv[++i], [](const std::string& field) { return field; });
+        else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc)
+        {
+            options.Sizes = parseList<std::pair<size_t, size_t>>(argv[++i], [](const std::string& field)
+            {
+                // Square grids unless the number of cells in y follows an x
+                size_t x = (size_t)std::max(atoll(field.c_str()), 1LL);
+                size_t separator = field.find('x');
+                size_t y = separator != std::string::npos ? (size_t)std::max(atoll(field.c_str() + separator + 1), 1LL) : x;
+                return std::make_pair(x, y);
+            });
+        }
+        else if (strcmp(argv[i], "--densities") == 0 && i + 1 < argc)
+            options.Densities = parseList<double>(argv[++i], [](const std::string& field) { return std::min(std::max(atof(field.c_str()), 0.0), 1.0); });
+        else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc)
+            options.Generations = (size_t)strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            options.Warmup = (size_t)strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc)
+            options.Repetitions = (size_t)strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--injections") == 0 && i + 1 < argc)
+            options.InjectionsPerBatch = (size_t)strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            options.Seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+            options.Settings.Device = argv[++i];
+        else if (strcmp(argv[i], "--mapped-file") == 0 && i + 1 < argc)
+            options.Settings.MappedFile = argv[++i];
+        else if (strcmp(argv[i], "--resident-mb") == 0 && i + 1 < argc)
+            options.Settings.ResidentMegabytes = (size_t)std::max(atoll(argv[++i]), 1LL);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc)
+            resultsPath = argv[++i];
+        else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = std::max(atof(argv[++i]), 0.0);
+        else
+        {
+            SIM_ERROR("Unknown argument: {0}", argv[i]);
+            return 1;
+        }
+    }
+
+    JsonValue current;
+    if (!resultsPath.empty())
+    {
+        if (!loadJson(resultsPath, current))
+            return 1;
+    }
+    else
+    {
+        std::vector<Result> results;
+        for (const std::pair<size_t, size_t>& size : options.Sizes)
+        {
+            for (double density : options.Densities)
+            {
+                for (const std::string& backend : options.Backends)
+                    results.push_back(run(options, backend, size.first, size.second, density));
+            }
+        }
+
+        std::string json = toJson(options, results);
+        if (outputPath.empty())
+        {
+            fputs(json.c_str(), stdout);
+        }
+        else
+        {
+            std::ofstream file(outputPath);
+            if (!(file << json))
+            {
+                SIM_ERROR("Cannot write benchmark results: {0}", outputPath);
+                return 1;
+            }
+        }
+        JsonParser(json).parseDocument(current);
+    }
+
+    if (baselinePath.empty())
+        return 0;
+
+    JsonValue baseline;
+    if (!loadJson(baselinePath, baseline))
+        return 1;
+    return compare(baseline, current, tolerance) > 0 ? 2 : 0;
+}
\ No newline at end of file
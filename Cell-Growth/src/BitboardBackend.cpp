@@ -0,0 +1,637 @@
+#include "BitboardBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef BITBOARD_AVX2
+#include <immintrin.h>
+#endif
+
+// MSVC compiles the AVX2 intrinsics anywhere, GCC and Clang only in the functions targeting AVX2
+#if defined(BITBOARD_AVX2) && !defined(_MSC_VER)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+// The bit-sliced counters only answer whether a count reaches six
+static_assert(CancerThreshold == 6 && CureThreshold == 6, "BitboardBackend only evaluates thresholds of six neighbors");
+
+constexpr size_t BitboardBackend::s_WordsPerTile;
+constexpr size_t BitboardBackend::s_RowsPerTile;
+
+namespace {
+
+unsigned int popcount(uint64_t word)
+{
+#ifdef _MSC_VER
+    return (unsigned int)__popcnt64(word);
+#else
+    return (unsigned int)__builtin_popcountll(word);
+#endif
+}
+
+// Full adders compress the eight neighbor bits of every cell into a four bit count
+uint64_t atLeastSix(const uint64_t neighbors[8])
+{
+    uint64_t sum0 = neighbors[0] ^ neighbors[1] ^ neighbors[2];
+    uint64_t carry0 = (neighbors[0] & neighbors[1]) | (neighbors[2] & (neighbors[0] ^ neighbors[1]));
+    uint64_t sum1 = neighbors[3] ^ neighbors[4] ^ neighbors[5];
+    uint64_t carry1 = (neighbors[3] & neighbors[4]) | (neighbors[5] & (neighbors[3] ^ neighbors[4]));
+    uint64_t sum2 = neighbors[6] ^ neighbors[7];
+    uint64_t carry2 = neighbors[6] & neighbors[7];
+
+    // The ones of the count are not needed, six and seven are told apart from five by the twos
+    uint64_t carryOnes = (sum0 & sum1) | (sum2 & (sum0 ^ sum1));
+    uint64_t sumTwos = carry0 ^ carry1 ^ carry2;
+    uint64_t carryTwos = (carry0 & carry1) | (carry2 & (carry0 ^ carry1));
+    uint64_t twos = sumTwos ^ carryOnes;
+    uint64_t carryFours = sumTwos & carryOnes;
+    uint64_t fours = carryTwos ^ carryFours;
+    uint64_t eights = carryTwos & carryFours;
+    return eights | (fours & twos);
+}
+
+#ifdef BITBOARD_AVX2
+bool hasAvx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    // The system also has to save the AVX registers
+    __cpuid(info, 1);
+    if (!(info[2] >> 27 & 1) || !(info[2] >> 28 & 1) || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5 & 1) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+AVX2_TARGET inline __m256i load(const uint64_t* words) { return _mm256_loadu_si256((const __m256i*)words); }
+AVX2_TARGET inline void store(uint64_t* words, __m256i value) { _mm256_storeu_si256((__m256i*)words, value); }
+
+// Four words of a row as shiftWest and shiftEast see them, the words around them are read with unaligned loads
+AVX2_TARGET inline __m256i shiftWestAvx2(const uint64_t* row, size_t w)
+{
+    return _mm256_or_si256(_mm256_slli_epi64(load(row + w), 1), _mm256_srli_epi64(load(row + w - 1), 63));
+}
+
+AVX2_TARGET inline __m256i shiftEastAvx2(const uint64_t* row, size_t w)
+{
+    return _mm256_or_si256(_mm256_srli_epi64(load(row + w), 1), _mm256_slli_epi64(load(row + w + 1), 63));
+}
+
+AVX2_TARGET inline void fullAdd(__m256i a, __m256i b, __m256i c, __m256i& sum, __m256i& carry)
+{
+    __m256i ab = _mm256_xor_si256(a, b);
+    sum = _mm256_xor_si256(ab, c);
+    carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, ab));
+}
+
+// The adders of atLeastSix on 256 cells
+AVX2_TARGET __m256i atLeastSix(const __m256i neighbors[8])
+{
+    __m256i sum0, carry0, sum1, carry1;
+    fullAdd(neighbors[0], neighbors[1], neighbors[2], sum0, carry0);
+    fullAdd(neighbors[3], neighbors[4], neighbors[5], sum1, carry1);
+    __m256i sum2 = _mm256_xor_si256(neighbors[6], neighbors[7]);
+    __m256i carry2 = _mm256_and_si256(neighbors[6], neighbors[7]);
+
+    __m256i sumOnes, carryOnes, sumTwos, carryTwos;
+    fullAdd(sum0, sum1, sum2, sumOnes, carryOnes);
+    fullAdd(carry0, carry1, carry2, sumTwos, carryTwos);
+    __m256i twos = _mm256_xor_si256(sumTwos, carryOnes);
+    __m256i carryFours = _mm256_and_si256(sumTwos, carryOnes);
+    __m256i fours = _mm256_xor_si256(carryTwos, carryFours);
+    __m256i eights = _mm256_and_si256(carryTwos, carryFours);
+    return _mm256_or_si256(eights, _mm256_and_si256(fours, twos));
+}
+#endif
+
+}
+
+BitboardBackend::BitboardBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border, bool profiling) :
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCellY(numberOfCellInY),
+    m_NumberOfCell(numberOfCellInX * numberOfCellInY),
+    m_RowsPerPartition(std::max(rowsPerPartition, (size_t)1)),
+    m_WordsPerRow((numberOfCellInX + 63) / 64),
+    m_Layout(numberOfCellInX, numberOfCellInY, m_RowsPerPartition),
+    m_Stride(m_WordsPerRow + 2),
+    m_Activity(numberOfCellInX, numberOfCellInY, 64 * s_WordsPerTile, s_RowsPerTile),
+#ifdef BITBOARD_AVX2
+    m_Avx2(hasAvx2())
+#else
+    m_Avx2(false)
+#endif
+{
+    size_t lastWordCells = m_NumberOfCellX - (m_WordsPerRow - 1) * 64;
+    m_LastWordMask = lastWordCells == 64 ? ~0ull : (1ull << lastWordCells) - 1;
+    // Only the cancer plane sees the border, a cancer fill sets every bit of it outside of the grid
+    m_BorderWord = border == BorderFill::CANCER ? ~0ull : 0;
+
+    size_t words = m_Stride * m_Layout.NumberOfRows;
+    for (size_t buffer = 0; buffer < 2; buffer++)
+    {
+        for (size_t plane = 0; plane < NUMBER_OF_PLANES; plane++)
+            m_Planes[buffer][plane].allocate(words);
+        fillGhosts(buffer);
+    }
+    m_Resolved.allocate(words);
+    m_Cured.allocate(words);
+    m_Moving.allocate(words);
+    m_States.allocate(m_NumberOfCell);
+    m_StaleTiles.assign(m_Activity.getNumberOfTiles(), 1);
+    m_Profiler.setEnabled(profiling);
+}
+
+bool BitboardBackend::inPartition(size_t y, int offset) const
+{
+    size_t neighborY = y + offset;
+    return neighborY < m_NumberOfCellY && neighborY / m_RowsPerPartition == y / m_RowsPerPartition;
+}
+
+void BitboardBackend::fillGhosts(size_t buffer)
+{
+    for (size_t plane = 0; plane < NUMBER_OF_PLANES; plane++)
+        memset(m_Planes[buffer][plane].data(), 0, m_Planes[buffer][plane].size() * sizeof(uint64_t));
+
+    // The rows between two partitions stay empty, neighbors are never counted across them
+    uint64_t* cancer = m_Planes[buffer][CANCER].data();
+    std::fill(cancer, cancer + m_Stride, m_BorderWord);
+    std::fill(cancer + (m_Layout.NumberOfRows - 1) * m_Stride, cancer + m_Layout.NumberOfRows * m_Stride, m_BorderWord);
+    for (size_t y = 0; y < m_NumberOfCellY; y++)
+    {
+        uint64_t* row = cancer + getWord(y);
+        row[-1] = m_BorderWord;
+        row[m_WordsPerRow] = m_BorderWord;
+        row[m_WordsPerRow - 1] = m_BorderWord & ~m_LastWordMask;
+    }
+}
+
+void BitboardBackend::resolveWord(size_t w, size_t beginY, size_t endY)
+{
+    uint64_t mask = w + 1 == m_WordsPerRow ? m_LastWordMask : ~0ull;
+    for (size_t y = beginY; y < endY; y++)
+    {
+        // Neighbors across a partition or the grid border are read from the ghost rows and words
+        const uint64_t* cancerRows[3];
+        const uint64_t* medecineRows[3];
+        for (int offset = -1; offset <= 1; offset++)
+        {
+            cancerRows[offset + 1] = getRow(CANCER, y) + offset * (ptrdiff_t)m_Stride;
+            medecineRows[offset + 1] = getRow(MEDECINE, y) + offset * (ptrdiff_t)m_Stride;
+        }
+
+        uint64_t cancerNeighbors[8];
+        uint64_t medecineNeighbors[8];
+        size_t neighbor = 0;
+        for (size_t row = 0; row < 3; row++)
+        {
+            cancerNeighbors[neighbor] = shiftWest(cancerRows[row], w);
+            cancerNeighbors[neighbor + 1] = shiftEast(cancerRows[row], w);
+            medecineNeighbors[neighbor] = shiftWest(medecineRows[row], w);
+            medecineNeighbors[neighbor + 1] = shiftEast(medecineRows[row], w);
+            if (row != 1)
+            {
+                cancerNeighbors[neighbor + 2] = cancerRows[row][w];
+                medecineNeighbors[neighbor + 2] = medecineRows[row][w];
+            }
+            neighbor += row == 1 ? 2 : 3;
+        }
+
+        // The bits past the last cell keep the border, they are never cured and never become cancer
+        uint64_t cancer = cancerRows[1][w];
+        uint64_t healthy = ~cancer & ~medecineRows[1][w] & mask;
+        uint64_t cured = cancer & atLeastSix(medecineNeighbors) & mask;
+        getRow(m_Cured, y)[w] = cured;
+        getRow(m_Resolved, y)[w] = (cancer & ~cured) | (healthy & atLeastSix(cancerNeighbors));
+    }
+}
+
+void BitboardBackend::consumeWord(size_t w, size_t beginY, size_t endY)
+{
+    for (size_t y = beginY; y < endY; y++)
+    {
+        // The ghosts are never cured
+        const uint64_t* curedRows[3];
+        for (int offset = -1; offset <= 1; offset++)
+            curedRows[offset + 1] = getRow(m_Cured, y) + offset * (ptrdiff_t)m_Stride;
+
+        // Medecine next to a cured cell is consumed, the rest moves
+        uint64_t nextToCured = 0;
+        for (size_t row = 0; row < 3; row++)
+        {
+            nextToCured |= shiftWest(curedRows[row], w) | shiftEast(curedRows[row], w);
+            if (row != 1)
+                nextToCured |= curedRows[row][w];
+        }
+        getRow(m_Moving, y)[w] = getRow(MEDECINE, y)[w] & ~nextToCured;
+    }
+}
+
+bool BitboardBackend::advanceWord(size_t w, size_t beginY, size_t endY)
+{
+    const size_t back = m_Front ^ 1;
+    uint64_t mask = w + 1 == m_WordsPerRow ? m_LastWordMask : ~0ull;
+    uint64_t changed = 0;
+    for (size_t y = beginY; y < endY; y++)
+    {
+        size_t word = getWord(y) + w;
+        uint64_t resolved = m_Resolved[word];
+        uint64_t moving = m_Moving[word];
+        uint64_t coversHealthy = m_Planes[m_Front][COVERS_HEALTHY][word];
+
+        // Medecine moving in, the first direction in offset order claims the cell, moving medecine keeps its own cell
+        uint64_t claimed = moving;
+        uint64_t incoming = 0;
+        uint64_t directions[3] = { 0, 0, 0 };
+        for (int j = 0; j < 8; j++)
+        {
+            // Columns of the sources, each cell sees the one at minus the offset of the direction
+            // Sources outside of the grid are ghost rows that never move, the ghost row of a seam is skipped
+            size_t sourceWord = m_Layout.getSourceRow(y, j) * m_Stride + 1;
+            uint64_t source[4];
+            const uint64_t* sourceRows[4] = { m_Moving.data() + sourceWord, m_Planes[m_Front][DIRECTION_0].data() + sourceWord,
+                m_Planes[m_Front][DIRECTION_1].data() + sourceWord, m_Planes[m_Front][DIRECTION_2].data() + sourceWord };
+            for (size_t plane = 0; plane < 4; plane++)
+            {
+                if (NeighborOffsetX[j] == 1)
+                    source[plane] = shiftWest(sourceRows[plane], w);
+                else if (NeighborOffsetX[j] == -1)
+                    source[plane] = shiftEast(sourceRows[plane], w);
+                else
+                    source[plane] = sourceRows[plane][w];
+            }
+
+            uint64_t arriving = source[0] & mask & ~claimed;
+            for (int bit = 0; bit < 3; bit++)
+                arriving &= (j >> bit & 1) ? source[bit + 1] : ~source[bit + 1];
+
+            claimed |= arriving;
+            incoming |= arriving;
+            for (int bit = 0; bit < 3; bit++)
+            {
+                if (j >> bit & 1)
+                    directions[bit] |= arriving;
+            }
+        }
+
+        // Moving medecine restores the cell it covered, medecine moving in covers the resolved cell
+        uint64_t nextPlanes[NUMBER_OF_PLANES];
+        nextPlanes[CANCER] = (resolved & ~incoming) | (moving & ~coversHealthy);
+        nextPlanes[MEDECINE] = incoming;
+        nextPlanes[COVERS_HEALTHY] = incoming & ~resolved;
+        nextPlanes[DIRECTION_0] = directions[0];
+        nextPlanes[DIRECTION_1] = directions[1];
+        nextPlanes[DIRECTION_2] = directions[2];
+        for (size_t plane = 0; plane < NUMBER_OF_PLANES; plane++)
+        {
+            changed |= nextPlanes[plane] ^ m_Planes[m_Front][plane][word];
+            m_Planes[back][plane][word] = nextPlanes[plane];
+        }
+    }
+    return changed != 0;
+}
+
+#ifdef BITBOARD_AVX2
+AVX2_TARGET void BitboardBackend::resolveWordsAvx2(size_t w, size_t beginY, size_t endY)
+{
+    __m256i mask = _mm256_set_epi64x(w + 4 == m_WordsPerRow ? (long long)m_LastWordMask : -1, -1, -1, -1);
+    for (size_t y = beginY; y < endY; y++)
+    {
+        const uint64_t* cancerRows[3];
+        const uint64_t* medecineRows[3];
+        for (int offset = -1; offset <= 1; offset++)
+        {
+            cancerRows[offset + 1] = getRow(CANCER, y) + offset * (ptrdiff_t)m_Stride;
+            medecineRows[offset + 1] = getRow(MEDECINE, y) + offset * (ptrdiff_t)m_Stride;
+        }
+
+        __m256i cancerNeighbors[8];
+        __m256i medecineNeighbors[8];
+        size_t neighbor = 0;
+        for (size_t row = 0; row < 3; row++)
+        {
+            cancerNeighbors[neighbor] = shiftWestAvx2(cancerRows[row], w);
+            cancerNeighbors[neighbor + 1] = shiftEastAvx2(cancerRows[row], w);
+            medecineNeighbors[neighbor] = shiftWestAvx2(medecineRows[row], w);
+            medecineNeighbors[neighbor + 1] = shiftEastAvx2(medecineRows[row], w);
+            if (row != 1)
+            {
+                cancerNeighbors[neighbor + 2] = load(cancerRows[row] + w);
+                medecineNeighbors[neighbor + 2] = load(medecineRows[row] + w);
+            }
+            neighbor += row == 1 ? 2 : 3;
+        }
+
+        __m256i cancer = load(cancerRows[1] + w);
+        __m256i healthy = _mm256_andnot_si256(_mm256_or_si256(cancer, load(medecineRows[1] + w)), mask);
+        __m256i cured = _mm256_and_si256(_mm256_and_si256(cancer, atLeastSix(medecineNeighbors)), mask);
+        store(getRow(m_Cured, y) + w, cured);
+        store(getRow(m_Resolved, y) + w, _mm256_or_si256(_mm256_andnot_si256(cured, cancer), _mm256_and_si256(healthy, atLeastSix(cancerNeighbors))));
+    }
+}
+
+AVX2_TARGET void BitboardBackend::consumeWordsAvx2(size_t w, size_t beginY, size_t endY)
+{
+    for (size_t y = beginY; y < endY; y++)
+    {
+        __m256i nextToCured = _mm256_setzero_si256();
+        for (int offset = -1; offset <= 1; offset++)
+        {
+            const uint64_t* curedRow = getRow(m_Cured, y) + offset * (ptrdiff_t)m_Stride;
+            nextToCured = _mm256_or_si256(nextToCured, _mm256_or_si256(shiftWestAvx2(curedRow, w), shiftEastAvx2(curedRow, w)));
+            if (offset != 0)
+                nextToCured = _mm256_or_si256(nextToCured, load(curedRow + w));
+        }
+        store(getRow(m_Moving, y) + w, _mm256_andnot_si256(nextToCured, load(getRow(MEDECINE, y) + w)));
+    }
+}
+
+AVX2_TARGET bool BitboardBackend::advanceWordsAvx2(size_t w, size_t beginY, size_t endY)
+{
+    const size_t back = m_Front ^ 1;
+    __m256i mask = _mm256_set_epi64x(w + 4 == m_WordsPerRow ? (long long)m_LastWordMask : -1, -1, -1, -1);
+    __m256i changed = _mm256_setzero_si256();
+    for (size_t y = beginY; y < endY; y++)
+    {
+        size_t word = getWord(y) + w;
+        __m256i resolved = load(m_Resolved.data() + word);
+        __m256i moving = load(m_Moving.data() + word);
+        __m256i coversHealthy = load(m_Planes[m_Front][COVERS_HEALTHY].data() + word);
+
+        __m256i claimed = moving;
+        __m256i incoming = _mm256_setzero_si256();
+        __m256i directions[3] = { incoming, incoming, incoming };
+        for (int j = 0; j < 8; j++)
+        {
+            size_t sourceWord = m_Layout.getSourceRow(y, j) * m_Stride + 1;
+            __m256i source[4];
+            const uint64_t* sourceRows[4] = { m_Moving.data() + sourceWord, m_Planes[m_Front][DIRECTION_0].data() + sourceWord,
+                m_Planes[m_Front][DIRECTION_1].data() + sourceWord, m_Planes[m_Front][DIRECTION_2].data() + sourceWord };
+            for (size_t plane = 0; plane < 4; plane++)
+            {
+                if (NeighborOffsetX[j] == 1)
+                    source[plane] = shiftWestAvx2(sourceRows[plane], w);
+                else if (NeighborOffsetX[j] == -1)
+                    source[plane] = shiftEastAvx2(sourceRows[plane], w);
+                else
+                    source[plane] = load(sourceRows[plane] + w);
+            }
+
+            __m256i arriving = _mm256_andnot_si256(claimed, _mm256_and_si256(source[0], mask));
+            for (int bit = 0; bit < 3; bit++)
+                arriving = (j >> bit & 1) ? _mm256_and_si256(arriving, source[bit + 1]) : _mm256_andnot_si256(source[bit + 1], arriving);
+
+            claimed = _mm256_or_si256(claimed, arriving);
+            incoming = _mm256_or_si256(incoming, arriving);
+            for (int bit = 0; bit < 3; bit++)
+            {
+                if (j >> bit & 1)
+                    directions[bit] = _mm256_or_si256(directions[bit], arriving);
+            }
+        }
+
+        __m256i nextPlanes[NUMBER_OF_PLANES];
+        nextPlanes[CANCER] = _mm256_or_si256(_mm256_andnot_si256(incoming, resolved), _mm256_andnot_si256(coversHealthy, moving));
+        nextPlanes[MEDECINE] = incoming;
+        nextPlanes[COVERS_HEALTHY] = _mm256_andnot_si256(resolved, incoming);
+        nextPlanes[DIRECTION_0] = directions[0];
+        nextPlanes[DIRECTION_1] = directions[1];
+        nextPlanes[DIRECTION_2] = directions[2];
+        for (size_t plane = 0; plane < NUMBER_OF_PLANES; plane++)
+        {
+            changed = _mm256_or_si256(changed, _mm256_xor_si256(nextPlanes[plane], load(m_Planes[m_Front][plane].data() + word)));
+            store(m_Planes[back][plane].data() + word, nextPlanes[plane]);
+        }
+    }
+    return !_mm256_testz_si256(changed, changed);
+}
+#endif
+
+void BitboardBackend::resolveTile(size_t beginW, size_t endW, size_t beginY, size_t endY)
+{
+    size_t w = beginW;
+#ifdef BITBOARD_AVX2
+    for (; m_Avx2 && w + 4 <= endW; w += 4)
+        resolveWordsAvx2(w, beginY, endY);
+#endif
+    for (; w < endW; w++)
+        resolveWord(w, beginY, endY);
+}
+
+void BitboardBackend::consumeTile(size_t beginW, size_t endW, size_t beginY, size_t endY)
+{
+    size_t w = beginW;
+#ifdef BITBOARD_AVX2
+    for (; m_Avx2 && w + 4 <= endW; w += 4)
+        consumeWordsAvx2(w, beginY, endY);
+#endif
+    for (; w < endW; w++)
+        consumeWord(w, beginY, endY);
+}
+
+bool BitboardBackend::advanceTile(size_t beginW, size_t endW, size_t beginY, size_t endY)
+{
+    bool changed = false;
+    size_t w = beginW;
+#ifdef BITBOARD_AVX2
+    for (; m_Avx2 && w + 4 <= endW; w += 4)
+        changed |= advanceWordsAvx2(w, beginY, endY);
+#endif
+    for (; w < endW; w++)
+        changed |= advanceWord(w, beginY, endY);
+    return changed;
+}
+
+void BitboardBackend::inject(const std::vector<Injection>& injections)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (const Injection& injection : injections)
+    {
+        size_t x = injection.Index % m_NumberOfCellX;
+        size_t y = injection.Index / m_NumberOfCellX;
+        int numberOfCells = getNumberOfInjectedCells(injection);
+        int counter = 0;
+        for (int j = 0; j < 8; j++)
+        {
+            size_t neighborX = x + NeighborOffsetX[j];
+            if (neighborX >= m_NumberOfCellX || !inPartition(y, NeighborOffsetY[j]))
+                continue;
+
+            counter++;
+            if (counter >= numberOfCells)
+                break;
+
+            size_t neighborY = y + NeighborOffsetY[j];
+            size_t word = getWord(neighborY) + neighborX / 64;
+            uint64_t bit = 1ull << (neighborX % 64);
+            if (m_Planes[m_Front][MEDECINE][word] & bit)
+                continue;
+
+            size_t tile = m_Activity.getTile(neighborX, neighborY);
+            m_Activity.markTile(tile);
+            m_StaleTiles[tile] = 1;
+
+            bool cancer = (m_Planes[m_Front][CANCER][word] & bit) != 0;
+            m_Planes[m_Front][CANCER][word] &= ~bit;
+            m_Planes[m_Front][MEDECINE][word] |= bit;
+            if (!cancer)
+                m_Planes[m_Front][COVERS_HEALTHY][word] |= bit;
+            else
+                m_Planes[m_Front][COVERS_HEALTHY][word] &= ~bit;
+            for (int direction = 0; direction < 3; direction++)
+            {
+                if (j >> direction & 1)
+                    m_Planes[m_Front][DIRECTION_0 + direction][word] |= bit;
+                else
+                    m_Planes[m_Front][DIRECTION_0 + direction][word] &= ~bit;
+            }
+        }
+    }
+    m_Profiler.record("Inject", start, injections.size() * 8 * NUMBER_OF_PLANES * sizeof(uint64_t));
+}
+
+void BitboardBackend::step()
+{
+    // Each pass reads the rows around its tile written by the previous one
+    // Tiles that are skipped hold the same planes in both buffers, they did not change during the last generation
+    // Resolve applies the cancer and cure rules, consume and advance update and move the medecine
+    m_Activity.update();
+    const std::vector<size_t>& tiles = m_Activity.getActiveTiles();
+    size_t activeBytes = tiles.size() * s_WordsPerTile * s_RowsPerTile * sizeof(uint64_t);
+    auto start = std::chrono::steady_clock::now();
+    forEachTile(tiles, [this](size_t, size_t beginW, size_t endW, size_t beginY, size_t endY) { resolveTile(beginW, endW, beginY, endY); });
+    m_Profiler.record("Resolve", start, 4 * activeBytes);
+    start = std::chrono::steady_clock::now();
+    forEachTile(tiles, [this](size_t, size_t beginW, size_t endW, size_t beginY, size_t endY) { consumeTile(beginW, endW, beginY, endY); });
+    m_Profiler.record("Consume", start, 3 * activeBytes);
+    start = std::chrono::steady_clock::now();
+    forEachTile(tiles, [this](size_t tile, size_t beginW, size_t endW, size_t beginY, size_t endY)
+    {
+        if (advanceTile(beginW, endW, beginY, endY))
+        {
+            m_Activity.markTile(tile);
+            m_StaleTiles[tile] = 1;
+        }
+    });
+    m_Profiler.record("Advance", start, (2 * NUMBER_OF_PLANES + 3) * activeBytes);
+    m_Front ^= 1;
+}
+
+void BitboardBackend::count(uint64_t counts[3])
+{
+    auto start = std::chrono::steady_clock::now();
+    counts[0] = counts[2] = 0;
+    size_t words = m_WordsPerRow * m_NumberOfCellY;
+    for (size_t y = 0; y < m_NumberOfCellY; y++)
+    {
+        const uint64_t* cancer = getRow(CANCER, y);
+        const uint64_t* medecine = getRow(MEDECINE, y);
+        for (size_t w = 0; w < m_WordsPerRow; w++)
+        {
+            uint64_t mask = w + 1 == m_WordsPerRow ? m_LastWordMask : ~0ull;
+            counts[0] += popcount(cancer[w] & mask);
+            counts[2] += popcount(medecine[w]);
+        }
+    }
+    counts[1] = m_NumberOfCell - counts[0] - counts[2];
+    m_Profiler.record("Count", start, 2 * words * sizeof(uint64_t));
+}
+
+void BitboardBackend::updateStates()
+{
+    std::vector<size_t> tiles;
+    for (size_t tile = 0; tile < m_StaleTiles.size(); tile++)
+    {
+        if (m_StaleTiles[tile])
+            tiles.push_back(tile);
+    }
+
+    forEachTile(tiles, [this](size_t tile, size_t beginW, size_t endW, size_t beginY, size_t endY)
+    {
+        size_t endX = std::min(endW * 64, m_NumberOfCellX);
+        for (size_t y = beginY; y < endY; y++)
+        {
+            const uint64_t* planes[NUMBER_OF_PLANES];
+            for (size_t plane = 0; plane < NUMBER_OF_PLANES; plane++)
+                planes[plane] = getRow(plane, y);
+
+            CellState* states = m_States.data() + y * m_NumberOfCellX;
+            for (size_t x = beginW * 64; x < endX; x++)
+            {
+                size_t w = x / 64;
+                size_t shift = x % 64;
+                if (planes[MEDECINE][w] >> shift & 1)
+                {
+                    CellType previousType = (planes[COVERS_HEALTHY][w] >> shift & 1) ? CellType::HEALTHY : CellType::CANCER;
+                    int direction = (int)((planes[DIRECTION_0][w] >> shift & 1) | (planes[DIRECTION_1][w] >> shift & 1) << 1
+                        | (planes[DIRECTION_2][w] >> shift & 1) << 2);
+                    states[x] = packMedecine(previousType, direction);
+                }
+                else
+                {
+                    states[x] = (CellState)((planes[CANCER][w] >> shift & 1) ? CellType::CANCER : CellType::HEALTHY);
+                }
+            }
+        }
+        m_StaleTiles[tile] = 0;
+    });
+}
+
+const CellState* BitboardBackend::getStates()
+{
+    updateStates();
+    return m_States.data();
+}
+
+void BitboardBackend::exportStates(CellState* states)
+{
+    updateStates();
+    memcpy(states, m_States.data(), m_NumberOfCell * sizeof(CellState));
+}
+
+void BitboardBackend::importStates(const CellState* states)
+{
+    fillGhosts(m_Front);
+    for (size_t y = 0; y < m_NumberOfCellY; y++)
+    {
+        uint64_t* planes[NUMBER_OF_PLANES];
+        for (size_t plane = 0; plane < NUMBER_OF_PLANES; plane++)
+            planes[plane] = getRow(plane, y);
+
+        for (size_t x = 0; x < m_NumberOfCellX; x++)
+        {
+            CellState state = states[y * m_NumberOfCellX + x];
+            uint64_t bit = 1ull << (x % 64);
+            size_t w = x / 64;
+            if (getCellType(state) == CellType::CANCER)
+            {
+                planes[CANCER][w] |= bit;
+            }
+            else if (getCellType(state) == CellType::MEDECINE)
+            {
+                planes[MEDECINE][w] |= bit;
+                if (getPreviousCellType(state) == CellType::HEALTHY)
+                    planes[COVERS_HEALTHY][w] |= bit;
+                int direction = getCellDirection(state);
+                for (int directionBit = 0; directionBit < 3; directionBit++)
+                {
+                    if (direction >> directionBit & 1)
+                        planes[DIRECTION_0 + directionBit][w] |= bit;
+                }
+            }
+        }
+    }
+    m_Activity.markAll();
+    std::fill(m_StaleTiles.begin(), m_StaleTiles.end(), (uint8_t)1);
+}
\ No newline at end of file
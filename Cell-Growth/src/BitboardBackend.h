@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ActivityMap.h"
+#include "AlignedArray.h"
+#include "SimulationBackend.h"
+#include "StageProfiler.h"
+#include "WorkStealingPool.h"
+
+// The AVX2 passes are compiled on x86 and only run when the processor supports them
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BITBOARD_AVX2
+#endif
+
+// Stores one bit per cell and per plane, rows are padded to whole 64 bit words with a ghost word on each side
+// The rules are evaluated on 64 cells at once, neighbors are counted with bit-sliced adders
+// A tile is four words wide, one AVX2 register, only the tiles around the ones that changed during the last generation are stepped
+class BitboardBackend : public SimulationBackend
+{
+private:
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCellY;
+    const size_t m_NumberOfCell;
+    const size_t m_RowsPerPartition;
+    const size_t m_WordsPerRow;
+    // Bits of the last word of a row that are cells, the others hold the border like the ghost words
+    uint64_t m_LastWordMask;
+    uint64_t m_BorderWord;
+    // Rows of the planes, ghost rows included, and words between two rows
+    const GhostLayout m_Layout;
+    const size_t m_Stride;
+
+    // A row is only a few words, tiles are taller than on the byte backend
+    static constexpr size_t s_WordsPerTile = 4;
+    static constexpr size_t s_RowsPerTile = 16;
+    ActivityMap m_Activity;
+    WorkStealingPool m_Pool;
+    StageProfiler m_Profiler;
+    const bool m_Avx2;
+
+    // Cancer and medecine, a cell with neither is healthy
+    // Medecine cells also keep whether they cover a healthy cell and the three bits of their direction
+    enum Plane
+    {
+        CANCER = 0,
+        MEDECINE,
+        COVERS_HEALTHY,
+        DIRECTION_0,
+        DIRECTION_1,
+        DIRECTION_2,
+        NUMBER_OF_PLANES
+    };
+
+    size_t m_Front = 0;
+    AlignedArray<uint64_t> m_Planes[2][NUMBER_OF_PLANES];
+
+    // Cancer cells after the resolve pass, cured cancer cells and medecine that moves this generation
+    AlignedArray<uint64_t> m_Resolved;
+    AlignedArray<uint64_t> m_Cured;
+    AlignedArray<uint64_t> m_Moving;
+
+    // Byte states for the draw view and export, only the tiles whose planes changed are converted again
+    AlignedArray<CellState> m_States;
+    std::vector<uint8_t> m_StaleTiles;
+
+private:
+    // First word of a row of the grid, the ghost words are at -1 and m_WordsPerRow
+    size_t getWord(size_t y) const { return m_Layout.getRow(y) * m_Stride + 1; }
+    uint64_t* getRow(size_t plane, size_t y) { return m_Planes[m_Front][plane].data() + getWord(y); }
+    uint64_t* getRow(AlignedArray<uint64_t>& plane, size_t y) { return plane.data() + getWord(y); }
+    // Whether the row at the offset is in the grid and in the same partition
+    bool inPartition(size_t y, int offset) const;
+    // Sets the ghost words and rows, the cells of the grid are cleared
+    void fillGhosts(size_t buffer);
+
+    // Word w of a row seen from the cells one column to the right or to the left of it, the ghost words are read at the ends
+    static uint64_t shiftWest(const uint64_t* row, size_t w) { return row[w] << 1 | (row + w)[-1] >> 63; }
+    static uint64_t shiftEast(const uint64_t* row, size_t w) { return row[w] >> 1 | row[w + 1] << 63; }
+
+    // The passes on the rows of the column of word w, the advance returns whether any cell changed
+    void resolveWord(size_t w, size_t beginY, size_t endY);
+    void consumeWord(size_t w, size_t beginY, size_t endY);
+    bool advanceWord(size_t w, size_t beginY, size_t endY);
+#ifdef BITBOARD_AVX2
+    // The same passes on the four columns of words from w
+    void resolveWordsAvx2(size_t w, size_t beginY, size_t endY);
+    void consumeWordsAvx2(size_t w, size_t beginY, size_t endY);
+    bool advanceWordsAvx2(size_t w, size_t beginY, size_t endY);
+#endif
+
+    void resolveTile(size_t beginW, size_t endW, size_t beginY, size_t endY);
+    void consumeTile(size_t beginW, size_t endW, size_t beginY, size_t endY);
+    // Returns whether any cell of the tile changed
+    bool advanceTile(size_t beginW, size_t endW, size_t beginY, size_t endY);
+
+    // Runs function(tile, beginW, endW, beginY, endY) on each of the tiles and returns once all of them are done
+    template<typename Function>
+    void forEachTile(const std::vector<size_t>& tiles, Function function)
+    {
+        m_Pool.parallelFor(tiles.size(), [this, &tiles, &function](size_t i)
+        {
+            TileBounds bounds = m_Activity.getTileBounds(tiles[i]);
+            function(tiles[i], bounds.BeginX / 64, (bounds.EndX + 63) / 64, bounds.BeginY, bounds.EndY);
+        });
+    }
+
+    void updateStates();
+
+public:
+    BitboardBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border = BorderFill::EMPTY,
+        bool profiling = false);
+
+    std::string getName() const override { return "Bitboard"; }
+
+    void inject(const std::vector<Injection>& injections) override;
+    void step() override;
+    void count(uint64_t counts[3]) override;
+
+    const CellState* getStates() override;
+    void exportStates(CellState* states) override;
+    void importStates(const CellState* states) override;
+    void setActivityTracking(bool enabled) override { m_Activity.setEnabled(enabled); }
+
+    StageProfiler* getProfiler() override { return &m_Profiler; }
+};
\ No newline at end of file
@@ -1,92 +1,65 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <unordered_set>
 
-#include "OpenCLWrapper.h"
+#include <Elysium.h>
 
+#include "AlignedArray.h"
+#include "Simulation.h"
+
+// Drawing and mouse input over the simulation, it paces the generations to the frames
 class CellArea
 {
 public:
 #ifdef _DEBUG
-    static constexpr size_t NumberOfCell_X = 200;
-    static constexpr size_t NumberOfCell_Y = 200;
+    static constexpr size_t DefaultNumberOfCell_X = 200;
+    static constexpr size_t DefaultNumberOfCell_Y = 200;
 #else
-    static constexpr size_t NumberOfCell_X = 400;
-    static constexpr size_t NumberOfCell_Y = 400;
+    static constexpr size_t DefaultNumberOfCell_X = 400;
+    static constexpr size_t DefaultNumberOfCell_Y = 400;
 #endif
 
-    static constexpr size_t NumberOfCell = NumberOfCell_X * NumberOfCell_Y;
-
 private:
-    OpenCLWrapper m_CLWrapper;
-
-    enum class CellType
-    {
-        NONE = -1,
-        CANCER = 0,
-        HEALTHY = 1,
-        MEDECINE = 2
-    };
-
-    struct PartitionStats
-    {
-        unsigned int NumberOfCancerCells = 0;
-        unsigned int NumberOfHealthyCells = 0;
-        unsigned int NumberOfMedecineCells = 0;
-    };
+    Simulation m_Simulation;
 
-    struct MedecineCell
-    {
-        int Valid = 0;
-        CellType PreviousType = CellType::NONE;
-        int Offset = 0;
-    };
-
-    static constexpr size_t s_NumberOfThreads = 4;
-    static constexpr size_t s_NumberOfCellsPerPartition = NumberOfCell / s_NumberOfThreads;
-    static constexpr size_t s_NumberOfCellsPerPartition_Y = NumberOfCell_Y / s_NumberOfThreads;
-
-    static constexpr Elysium::Vector4 s_ColorGreen = { 0.0f, 1.0f, 0.0f, 1.0f };
-    static constexpr Elysium::Vector4 s_ColorRed = { 0.75f, 0.0f, 0.0f, 1.0f };
-    static constexpr Elysium::Vector4 s_ColorYellow = { 1.0f, 1.0f, 0.0f, 1.0f };
+public:
+    // The number of rows is rounded up to whole partitions by the simulation
+    const size_t NumberOfCell_X;
+    const size_t NumberOfCell_Y;
+    const size_t NumberOfCell;
 
-    static constexpr int s_NeighborIndexes[8] = { -(int)NumberOfCell_X - 1, -(int)NumberOfCell_X , -(int)NumberOfCell_X + 1,
-        -1, 1,
-        (int)NumberOfCell_X - 1, (int)NumberOfCell_X, (int)NumberOfCell_X + 1 };
+private:
+    // Colors are only derived from the type when drawing, indexed by CellType
+    static constexpr Elysium::Vector4 s_Palette[3] = {
+        { 0.75f, 0.0f, 0.0f, 1.0f },
+        { 0.0f, 1.0f, 0.0f, 1.0f },
+        { 1.0f, 1.0f, 0.0f, 1.0f } };
 
     float m_CellSize = 2.5f;
     float m_CurrentTime = 0.0f;
 
     std::unordered_set<size_t>m_InputBuffer;
 
-    std::array<MedecineCell, NumberOfCell> m_MedecineCells;
-    std::array<Elysium::Vector4, NumberOfCell> m_MedecineColors;
-    std::array<CellType, NumberOfCell> m_Types = { CellType::HEALTHY };
-
-    std::array<int, s_NumberOfCellsPerPartition> m_Indexes = { 0 };
-    std::vector<int> m_Neighbors;
+    // Generation being drawn, owned by the backend
+    const CellState* m_ViewStates = nullptr;
 
 public:
-    std::array<Elysium::Vector2, NumberOfCell> Positions;
-    std::array<Elysium::Vector4, NumberOfCell> Colors;
-
-    unsigned int NumberOfCancerCells = 0;
-    unsigned int NumberOfHealthyCells = 0;
-    unsigned int NumberOfMedecineCells = 0;
-
-private:
-    void setNeighbor(int index);
-
-    void updateHealthyAndCancerCells();
-    void updateMedecineCells();
+    AlignedArray<Elysium::Vector2> Positions;
 
-    void countCells();
+    // Moving average of the host time spent on a generation, in milliseconds
+    double StepTime = 0.0;
 
 public:
-    CellArea(Elysium::Vector2 offset);
-    ~CellArea();
+    CellArea(size_t numberOfCellInX, size_t numberOfCellInY, Elysium::Vector2 offset, const BackendSettings& settings = BackendSettings());
 
     void onUpdate(Elysium::Timestep ts);
+    const Elysium::Vector4& getColor(size_t index) const { return s_Palette[m_ViewStates[index] & CellTypeMask]; }
     size_t getIndex(const Elysium::Vector2& position);
+    const Simulation& getSimulation() const { return m_Simulation; }
+    Simulation& getSimulation() { return m_Simulation; }
     void injectMedecine(const Elysium::Vector2& position);
+    // Jumps 2^log2Generations generations ahead without injections, medecine clicked meanwhile is injected afterwards
+    void fastForward(unsigned int log2Generations);
 };
\ No newline at end of file
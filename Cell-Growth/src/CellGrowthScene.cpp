@@ -1,11 +1,11 @@
 #include "CellGrowthScene.h"
 
-CellGrowthScene::CellGrowthScene(unsigned int width, unsigned int height) :
+CellGrowthScene::CellGrowthScene(unsigned int width, unsigned int height, size_t numberOfCellInX, size_t numberOfCellInY, const BackendSettings& settings) :
     Elysium::Scene("Cell Growth"),
     m_WindowWidth(width),
     m_WindowHeight(height),
     m_CameraController((float)width / (float)height, 500.0f),
-    m_Cells({ (float)CellArea::NumberOfCell_X * 0.5f, CellArea::NumberOfCell_Y * 0.5f })
+    m_Cells(numberOfCellInX, numberOfCellInY, { (float)numberOfCellInX * 0.5f, (float)numberOfCellInY * 0.5f }, settings)
 {
     m_CameraController.CameraTranslationSpeed = 200.0f;
     m_CameraController.CameraZoomSpeed = 10.0f;
@@ -33,25 +33,72 @@ void CellGrowthScene::onUpdate(Elysium::Timestep ts)
 
     m_CameraController.onUpdate(ts);
     Elysium::Renderer2D::beginScene(m_CameraController.getCamera());
-    for (size_t i = 0; i < CellArea::NumberOfCell; i++)
+    for (size_t i = 0; i < m_Cells.NumberOfCell; i++)
     {
-        Elysium::Renderer2D::drawPoint(m_Cells.Positions[i], m_Cells.Colors[i]);
+        Elysium::Renderer2D::drawPoint(m_Cells.Positions[i], m_Cells.getColor(i));
     }
     Elysium::Renderer2D::endScene();
 
+    Simulation& simulation = m_Cells.getSimulation();
     ImGui::Begin("Cell Growth");
     ImGui::Checkbox("Pause Scene", &m_Pause);
-    ImGui::Text("Number of Cells: %d", CellArea::NumberOfCell);
-    ImGui::Text("Number of Cells Accounted: %d", m_Cells.NumberOfCancerCells + m_Cells.NumberOfHealthyCells + m_Cells.NumberOfMedecineCells);
-    ImGui::Text("Number of Cancer Cells: %d", m_Cells.NumberOfCancerCells);
-    ImGui::Text("Number of Healthy Cells: %d", m_Cells.NumberOfHealthyCells);
-    ImGui::Text("Number of Medecine Cells: %d", m_Cells.NumberOfMedecineCells);
+    ImGui::Text("Backend: %s", simulation.getBackendName().c_str());
+    if (simulation.hasTiledKernels())
+    {
+        bool tiledKernels = simulation.getTiledKernels();
+        if (ImGui::Checkbox("Tiled Kernels", &tiledKernels))
+            simulation.setTiledKernels(tiledKernels);
+    }
+    ImGui::SliderInt("Fast-Forward (log2 generations)", &m_FastForward, 0, 20);
+    if (ImGui::Button("Fast-Forward"))
+        m_Cells.fastForward((unsigned int)m_FastForward);
+    ImGui::Text("Grid Size: %zux%zu", m_Cells.NumberOfCell_X, m_Cells.NumberOfCell_Y);
+    ImGui::Text("Number of Cells: %zu", m_Cells.NumberOfCell);
+    ImGui::Text("Generation: %llu", (unsigned long long)simulation.getGeneration());
+    ImGui::Text("Number of Cells Accounted: %llu",
+        (unsigned long long)(simulation.getNumberOfCancerCells() + simulation.getNumberOfHealthyCells() + simulation.getNumberOfMedecineCells()));
+    ImGui::Text("Number of Cancer Cells: %llu", (unsigned long long)simulation.getNumberOfCancerCells());
+    ImGui::Text("Number of Healthy Cells: %llu", (unsigned long long)simulation.getNumberOfHealthyCells());
+    ImGui::Text("Number of Medecine Cells: %llu", (unsigned long long)simulation.getNumberOfMedecineCells());
     ImGui::Text("Cell Index: %d", m_Cells.getIndex(cursorPosition));
     ImGui::End();
 
     ImGui::Begin("Statistics");
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
     ImGui::Text("Number of Draw Calls: %d", Elysium::Renderer2D::getStats().DrawCount);
+    ImGui::Text("Simulation %.3f ms/generation (%.1f Mcells/s)", m_Cells.StepTime,
+        m_Cells.StepTime > 0.0 ? (double)m_Cells.NumberOfCell / m_Cells.StepTime * 1e-3 : 0.0);
+    const StageProfiler* profiler = simulation.getProfiler();
+    if (profiler && profiler->isEnabled())
+    {
+        // Rolling averages over the last commands of each stage
+        ImGui::Separator();
+        ImGui::Columns(7, "Stages");
+        for (const char* header : { "Stage", "Average ms", "P99 ms", "Submit ms", "Start ms", "GB/s", "Samples" })
+        {
+            ImGui::Text("%s", header);
+            ImGui::NextColumn();
+        }
+        ImGui::Separator();
+        for (const StageProfiler::StageStats& stage : profiler->getStats())
+        {
+            ImGui::Text("%s", stage.Name.c_str());
+            ImGui::NextColumn();
+            ImGui::Text("%.3f", stage.AverageMs);
+            ImGui::NextColumn();
+            ImGui::Text("%.3f", stage.P99Ms);
+            ImGui::NextColumn();
+            ImGui::Text("%.3f", stage.SubmitMs);
+            ImGui::NextColumn();
+            ImGui::Text("%.3f", stage.StartMs);
+            ImGui::NextColumn();
+            ImGui::Text("%.2f", stage.GBPerSecond);
+            ImGui::NextColumn();
+            ImGui::Text("%zu", stage.Samples);
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
     ImGui::End();
 
     Elysium::Renderer2D::resetStats();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "CellArea.h"
+#include "StageProfiler.h"
 
 #include <Elysium.h>
 
@@ -9,6 +10,7 @@ class CellGrowthScene : public Elysium::Scene
 private:
     bool m_Pause = true;
     float m_Cooldown = 0.0f;
+    int m_FastForward = 10;
     unsigned int m_WindowWidth;
     unsigned int m_WindowHeight;
 
@@ -20,7 +22,7 @@ private:
     Elysium::Vector2 getCursorPosition();
 
 public:
-    CellGrowthScene(unsigned int width, unsigned int height);
+    CellGrowthScene(unsigned int width, unsigned int height, size_t numberOfCellInX, size_t numberOfCellInY, const BackendSettings& settings);
     ~CellGrowthScene();
 
     void onUpdate(Elysium::Timestep ts) override;
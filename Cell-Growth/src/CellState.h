@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// Cell encoding shared by the kernels and the native backends, it has to match res/cl/cell_kernel.cl
+enum class CellType : uint8_t
+{
+    CANCER = 0,
+    HEALTHY = 1,
+    MEDECINE = 2
+};
+
+// One byte per cell, the type in bits 0-1, the type covered by a medecine cell in bit 2 and its direction in bits 3-5
+using CellState = uint8_t;
+
+static constexpr CellState CellTypeMask = 0x3;
+static constexpr unsigned int CellPreviousTypeShift = 2;
+static constexpr unsigned int CellDirectionShift = 3;
+
+// Resolved value of a cancer cell surrounded by enough medecine, it becomes healthy once the generation is advanced
+static constexpr uint8_t CellCured = 3;
+
+static constexpr int CancerThreshold = 6;
+static constexpr int CureThreshold = 6;
+
+// Neighbors in direction order, a medecine cell moves by the offset of its direction
+static constexpr int NeighborOffsetX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+static constexpr int NeighborOffsetY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+inline CellType getCellType(CellState state) { return (CellType)(state & CellTypeMask); }
+inline CellType getPreviousCellType(CellState state) { return (CellType)(state >> CellPreviousTypeShift & 0x1); }
+inline int getCellDirection(CellState state) { return state >> CellDirectionShift & 0x7; }
+
+inline CellState packMedecine(CellType previousType, int direction)
+{
+    return (CellState)((int)CellType::MEDECINE | (int)previousType << CellPreviousTypeShift | direction << CellDirectionShift);
+}
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include "CpuBackend.h"
+
+#include <algorithm>
+#include <chrono>
+
+constexpr size_t CpuBackend::s_ColumnsPerTile;
+constexpr size_t CpuBackend::s_RowsPerTile;
+
+CpuBackend::CpuBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border, bool profiling) :
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCellY(numberOfCellInY),
+    m_NumberOfCell(numberOfCellInX * numberOfCellInY),
+    m_RowsPerPartition(std::max(rowsPerPartition, (size_t)1)),
+    m_Layout(numberOfCellInX, numberOfCellInY, m_RowsPerPartition),
+    m_Activity(numberOfCellInX, numberOfCellInY, s_ColumnsPerTile, s_RowsPerTile)
+{
+    // Ghosts are never stepped, they keep these values in both generations
+    for (size_t i = 0; i < 2; i++)
+    {
+        m_States[i].allocate(m_Layout.NumberOfCell);
+        m_Layout.fillGhosts(m_States[i].data(), getBorderCell(border), VoidCell);
+    }
+    m_ResolvedCells.allocate(m_Layout.NumberOfCell);
+    m_Layout.fillGhosts(m_ResolvedCells.data(), getBorderCell(border), VoidCell);
+    m_ConsumedCells.allocate(m_Layout.NumberOfCell);
+    m_ViewStates.allocate(m_NumberOfCell);
+    m_Profiler.setEnabled(profiling);
+}
+
+bool CpuBackend::inPartition(size_t x, size_t y, int direction) const
+{
+    // Unsigned wrap around makes the cells before the first row or column out of range too
+    size_t neighborX = x + NeighborOffsetX[direction];
+    size_t neighborY = y + NeighborOffsetY[direction];
+    return neighborX < m_NumberOfCellX && neighborY < m_NumberOfCellY
+        && neighborY / m_RowsPerPartition == y / m_RowsPerPartition;
+}
+
+void CpuBackend::resolveTile(const TileBounds& bounds)
+{
+    // Neighbors are counted from sums over the columns of three rows, with one more column on each side of the tile
+    // Those rows and columns are ghosts at the borders and the seams, every row is summed the same way
+    uint8_t cancerColumns[s_ColumnsPerTile + 2];
+    uint8_t medecineColumns[s_ColumnsPerTile + 2];
+    size_t numberOfColumns = bounds.EndX - bounds.BeginX;
+    const size_t stride = m_Layout.Stride;
+    const CellState* states = m_States[m_Front].data();
+    for (size_t y = bounds.BeginY; y < bounds.EndY; y++)
+    {
+        // The first column is the one on the left of the tile, the cells of the tile start at the second
+        const CellState* row = states + m_Layout.getIndex(bounds.BeginX, y) - 1;
+        const CellState* above = row - stride;
+        const CellState* below = row + stride;
+        for (size_t column = 0; column < numberOfColumns + 2; column++)
+        {
+            uint8_t types[3] = { (uint8_t)(above[column] & CellTypeMask), (uint8_t)(row[column] & CellTypeMask), (uint8_t)(below[column] & CellTypeMask) };
+            cancerColumns[column] = (types[0] == (uint8_t)CellType::CANCER) + (types[1] == (uint8_t)CellType::CANCER) + (types[2] == (uint8_t)CellType::CANCER);
+            medecineColumns[column] = (types[0] == (uint8_t)CellType::MEDECINE) + (types[1] == (uint8_t)CellType::MEDECINE)
+                + (types[2] == (uint8_t)CellType::MEDECINE);
+        }
+
+        uint8_t* resolvedCells = m_ResolvedCells.data() + m_Layout.getIndex(bounds.BeginX, y);
+        for (size_t column = 0; column < numberOfColumns; column++)
+        {
+            uint8_t type = row[column + 1] & CellTypeMask;
+            int cancer = cancerColumns[column] + cancerColumns[column + 1] + cancerColumns[column + 2] - (type == (uint8_t)CellType::CANCER);
+            int medecine = medecineColumns[column] + medecineColumns[column + 1] + medecineColumns[column + 2] - (type == (uint8_t)CellType::MEDECINE);
+
+            uint8_t resolved = type;
+            if (type == (uint8_t)CellType::HEALTHY && cancer >= CancerThreshold)
+                resolved = (uint8_t)CellType::CANCER;
+            else if (type == (uint8_t)CellType::CANCER && medecine >= CureThreshold)
+                resolved = CellCured;
+            resolvedCells[column] = resolved;
+        }
+    }
+}
+
+void CpuBackend::consumeTile(const TileBounds& bounds)
+{
+    uint8_t curedColumns[s_ColumnsPerTile + 2];
+    size_t numberOfColumns = bounds.EndX - bounds.BeginX;
+    const size_t stride = m_Layout.Stride;
+    const uint8_t* resolvedCells = m_ResolvedCells.data();
+    for (size_t y = bounds.BeginY; y < bounds.EndY; y++)
+    {
+        // Ghosts never resolve to a cured cell
+        const uint8_t* row = resolvedCells + m_Layout.getIndex(bounds.BeginX, y) - 1;
+        const uint8_t* above = row - stride;
+        const uint8_t* below = row + stride;
+        for (size_t column = 0; column < numberOfColumns + 2; column++)
+        {
+            // A cured cell is never medecine, the cell itself can be counted with its column
+            curedColumns[column] = (row[column] == CellCured) | (above[column] == CellCured) | (below[column] == CellCured);
+        }
+
+        uint8_t* consumedCells = m_ConsumedCells.data() + m_Layout.getIndex(bounds.BeginX, y);
+        for (size_t column = 0; column < numberOfColumns; column++)
+        {
+            consumedCells[column] = row[column + 1] == (uint8_t)CellType::MEDECINE
+                && (curedColumns[column] | curedColumns[column + 1] | curedColumns[column + 2]);
+        }
+    }
+}
+
+void CpuBackend::advanceTile(size_t tile, const TileBounds& bounds)
+{
+    const CellState* states = m_States[m_Front].data();
+    const uint8_t* resolvedCells = m_ResolvedCells.data();
+    const uint8_t* consumedCells = m_ConsumedCells.data();
+    CellState* nextStates = m_States[m_Front ^ 1].data();
+    bool changed = false;
+    for (size_t y = bounds.BeginY; y < bounds.EndY; y++)
+    {
+        // Sources are ghosts outside of the grid, which are never medecine, and skip the ghost row of a seam
+        ptrdiff_t sourceOffsets[8];
+        for (int j = 0; j < 8; j++)
+            sourceOffsets[j] = m_Layout.getSourceOffset(y, j);
+
+        for (size_t i = m_Layout.getIndex(bounds.BeginX, y); i < m_Layout.getIndex(bounds.EndX, y); i++)
+        {
+            // Medecine that is not consumed restores the cell it was covering and keeps others from moving in
+            uint8_t resolved = resolvedCells[i];
+            CellState nextState;
+            if (resolved == (uint8_t)CellType::MEDECINE && !consumedCells[i])
+            {
+                nextState = (CellState)getPreviousCellType(states[i]);
+            }
+            else
+            {
+                // Cured cells and consumed medecine become healthy
+                CellType type = resolved >= (uint8_t)CellType::MEDECINE ? CellType::HEALTHY : (CellType)resolved;
+
+                // Medecine moving into this cell, the first neighbor in offset order wins
+                nextState = (CellState)type;
+                for (int j = 0; j < 8; j++)
+                {
+                    size_t source = i + sourceOffsets[j];
+                    CellState sourceState = states[source];
+                    if (getCellType(sourceState) == CellType::MEDECINE && getCellDirection(sourceState) == j && !consumedCells[source])
+                    {
+                        nextState = packMedecine(type, j);
+                        break;
+                    }
+                }
+            }
+            changed |= nextState != states[i];
+            nextStates[i] = nextState;
+        }
+    }
+
+    if (changed)
+        m_Activity.markTile(tile);
+}
+
+void CpuBackend::inject(const std::vector<Injection>& injections)
+{
+    auto start = std::chrono::steady_clock::now();
+    CellState* states = m_States[m_Front].data();
+    for (const Injection& injection : injections)
+    {
+        size_t x = injection.Index % m_NumberOfCellX;
+        size_t y = injection.Index / m_NumberOfCellX;
+        int numberOfCells = getNumberOfInjectedCells(injection);
+        int counter = 0;
+        for (int j = 0; j < 8; j++)
+        {
+            if (!inPartition(x, y, j))
+                continue;
+
+            counter++;
+            if (counter >= numberOfCells)
+                break;
+
+            size_t neighbor = m_Layout.getIndex(x, y) + m_Layout.getOffset(j);
+            if (getCellType(states[neighbor]) != CellType::MEDECINE)
+            {
+                states[neighbor] = packMedecine(getCellType(states[neighbor]), j);
+                m_Activity.markCell(x + NeighborOffsetX[j], y + NeighborOffsetY[j]);
+            }
+        }
+    }
+    m_ViewDirty = true;
+    m_Profiler.record("Inject", start, injections.size() * 8 * sizeof(CellState));
+}
+
+void CpuBackend::step()
+{
+    // Each pass reads what the previous one wrote around its tile, every tile finishes a pass before the next starts
+    // Tiles that are skipped hold the same states in both buffers, they did not change during the last generation
+    // Resolve applies the cancer and cure rules, consume and advance update and move the medecine
+    m_Activity.update();
+    size_t activeCells = m_Activity.getActiveTiles().size() * s_ColumnsPerTile * s_RowsPerTile;
+    auto start = std::chrono::steady_clock::now();
+    forEachActiveTile([this](size_t, const TileBounds& bounds) { resolveTile(bounds); });
+    m_Profiler.record("Resolve", start, 2 * activeCells);
+    start = std::chrono::steady_clock::now();
+    forEachActiveTile([this](size_t, const TileBounds& bounds) { consumeTile(bounds); });
+    m_Profiler.record("Consume", start, 2 * activeCells);
+    start = std::chrono::steady_clock::now();
+    forEachActiveTile([this](size_t tile, const TileBounds& bounds) { advanceTile(tile, bounds); });
+    m_Profiler.record("Advance", start, 4 * activeCells);
+    m_Front ^= 1;
+    m_ViewDirty = true;
+}
+
+void CpuBackend::count(uint64_t counts[3])
+{
+    // Counted over bands of whole rows, every tile is counted whether it changed or not
+    auto start = std::chrono::steady_clock::now();
+    size_t numberOfBands = (m_NumberOfCellY + s_RowsPerTile - 1) / s_RowsPerTile;
+    std::vector<uint64_t> bandCounts(numberOfBands * 3, 0);
+    const CellState* states = m_States[m_Front].data();
+    m_Pool.parallelFor(numberOfBands, [this, states, &bandCounts](size_t band)
+    {
+        size_t begin = band * s_RowsPerTile;
+        size_t end = std::min(begin + s_RowsPerTile, m_NumberOfCellY);
+        uint64_t localCounts[3] = { 0, 0, 0 };
+        for (size_t y = begin; y < end; y++)
+        {
+            for (size_t i = m_Layout.getIndex(0, y); i < m_Layout.getIndex(m_NumberOfCellX, y); i++)
+                localCounts[states[i] & CellTypeMask]++;
+        }
+        for (size_t type = 0; type < 3; type++)
+            bandCounts[band * 3 + type] = localCounts[type];
+    });
+
+    for (size_t type = 0; type < 3; type++)
+    {
+        counts[type] = 0;
+        for (size_t band = 0; band < numberOfBands; band++)
+            counts[type] += bandCounts[band * 3 + type];
+    }
+    m_Profiler.record("Count", start, m_NumberOfCell * sizeof(CellState));
+}
+
+const CellState* CpuBackend::getStates()
+{
+    if (m_ViewDirty)
+    {
+        m_Layout.unpack(m_States[m_Front].data(), m_ViewStates.data());
+        m_ViewDirty = false;
+    }
+    return m_ViewStates.data();
+}
+
+void CpuBackend::exportStates(CellState* states)
+{
+    m_Layout.unpack(m_States[m_Front].data(), states);
+}
+
+void CpuBackend::importStates(const CellState* states)
+{
+    m_Layout.pack(states, m_States[m_Front].data());
+    m_Activity.markAll();
+    m_ViewDirty = true;
+}
\ No newline at end of file
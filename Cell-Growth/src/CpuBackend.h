@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include "ActivityMap.h"
+#include "AlignedArray.h"
+#include "SimulationBackend.h"
+#include "StageProfiler.h"
+#include "WorkStealingPool.h"
+
+// Native implementation of the kernel rules, every pass is split in tiles stepped by a work-stealing pool
+// Only the tiles around the ones that changed during the last generation are stepped
+class CpuBackend : public SimulationBackend
+{
+private:
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCellY;
+    const size_t m_NumberOfCell;
+    // Neighbors are only counted inside a partition of whole rows, medecine moves across partitions
+    const size_t m_RowsPerPartition;
+    // Rows around a row and columns around the grid are read the same way everywhere, the ghosts hold the border
+    const GhostLayout m_Layout;
+    // Tiles are small enough that workers finishing early can steal from the others
+    static constexpr size_t s_ColumnsPerTile = 64;
+    static constexpr size_t s_RowsPerTile = 8;
+    ActivityMap m_Activity;
+    WorkStealingPool m_Pool;
+    StageProfiler m_Profiler;
+
+    size_t m_Front = 0;
+    AlignedArray<CellState> m_States[2];
+    AlignedArray<uint8_t> m_ResolvedCells;
+    // Medecine cells next to a cured cell, they neither stay nor move
+    AlignedArray<uint8_t> m_ConsumedCells;
+    // Copy of the current generation without its ghosts for drawing, only made when asked for
+    AlignedArray<CellState> m_ViewStates;
+    bool m_ViewDirty = true;
+
+private:
+    bool inPartition(size_t x, size_t y, int direction) const;
+
+    void resolveTile(const TileBounds& bounds);
+    void consumeTile(const TileBounds& bounds);
+    void advanceTile(size_t tile, const TileBounds& bounds);
+
+    // Runs function(tile, bounds) on every active tile and returns once all of them are done
+    template<typename Function>
+    void forEachActiveTile(Function function)
+    {
+        const std::vector<size_t>& tiles = m_Activity.getActiveTiles();
+        m_Pool.parallelFor(tiles.size(), [this, &tiles, &function](size_t i)
+        {
+            function(tiles[i], m_Activity.getTileBounds(tiles[i]));
+        });
+    }
+
+public:
+    CpuBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border = BorderFill::EMPTY,
+        bool profiling = false);
+
+    std::string getName() const override { return "CPU (" + std::to_string(m_Pool.getNumberOfThreads()) + " threads)"; }
+    size_t getNumberOfWorkers() const { return m_Pool.getNumberOfThreads(); }
+
+    void inject(const std::vector<Injection>& injections) override;
+    void step() override;
+    void count(uint64_t counts[3]) override;
+
+    const CellState* getStates() override;
+    void exportStates(CellState* states) override;
+    void importStates(const CellState* states) override;
+    void setActivityTracking(bool enabled) override { m_Activity.setEnabled(enabled); }
+
+    StageProfiler* getProfiler() override { return &m_Profiler; }
+};
\ No newline at end of file
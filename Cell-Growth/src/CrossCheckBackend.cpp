@@ -0,0 +1,75 @@
+#include "CrossCheckBackend.h"
+
+#include "SimulationLog.h"
+
+CrossCheckBackend::CrossCheckBackend(std::unique_ptr<SimulationBackend> primary, std::unique_ptr<SimulationBackend> secondary,
+    size_t numberOfCellInX, size_t numberOfCellInY) :
+    m_Primary(std::move(primary)),
+    m_Secondary(std::move(secondary)),
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCell(numberOfCellInX * numberOfCellInY),
+    m_PrimaryStates(m_NumberOfCell),
+    m_SecondaryStates(m_NumberOfCell)
+{
+    SIM_INFO("Cross-checking {0} against {1}", m_Primary->getName(), m_Secondary->getName());
+}
+
+void CrossCheckBackend::compare()
+{
+    if (m_Diverged)
+        return;
+
+    m_Primary->exportStates(m_PrimaryStates.data());
+    m_Secondary->exportStates(m_SecondaryStates.data());
+    for (size_t i = 0; i < m_NumberOfCell; i++)
+    {
+        if (m_PrimaryStates[i] == m_SecondaryStates[i])
+            continue;
+
+        m_Diverged = true;
+        SIM_ERROR("Backends diverge at generation {0}, cell {1} ({2}, {3}): {4} has state {5:#x}, {6} has state {7:#x}",
+            m_Generation, i, i % m_NumberOfCellX, i / m_NumberOfCellX,
+            m_Primary->getName(), (unsigned int)m_PrimaryStates[i], m_Secondary->getName(), (unsigned int)m_SecondaryStates[i]);
+        return;
+    }
+}
+
+void CrossCheckBackend::inject(const std::vector<Injection>& injections)
+{
+    m_Primary->inject(injections);
+    m_Secondary->inject(injections);
+}
+
+void CrossCheckBackend::step()
+{
+    m_Primary->step();
+    m_Secondary->step();
+    m_Generation++;
+
+    // Asynchronous backends only hold the generation of the last step once finished, the comparison waits for both
+    // Every generation is compared so that the first divergence is the one reported
+    if (!m_Diverged)
+    {
+        m_Primary->finish();
+        m_Secondary->finish();
+        compare();
+    }
+}
+
+void CrossCheckBackend::finish()
+{
+    m_Primary->finish();
+    m_Secondary->finish();
+}
+
+void CrossCheckBackend::importStates(const CellState* states)
+{
+    m_Primary->importStates(states);
+    m_Secondary->importStates(states);
+}
+
+void CrossCheckBackend::setActivityTracking(bool enabled)
+{
+    m_Primary->setActivityTracking(enabled);
+    m_Secondary->setActivityTracking(enabled);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+
+#include "AlignedArray.h"
+#include "SimulationBackend.h"
+
+// Runs two backends in lockstep and compares every generation, the first one is drawn and counted
+class CrossCheckBackend : public SimulationBackend
+{
+private:
+    std::unique_ptr<SimulationBackend> m_Primary;
+    std::unique_ptr<SimulationBackend> m_Secondary;
+
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCell;
+    AlignedArray<CellState> m_PrimaryStates;
+    AlignedArray<CellState> m_SecondaryStates;
+
+    size_t m_Generation = 0;
+    // Only the first divergence is reported, the backends are not compared afterwards
+    bool m_Diverged = false;
+
+private:
+    void compare();
+
+public:
+    CrossCheckBackend(std::unique_ptr<SimulationBackend> primary, std::unique_ptr<SimulationBackend> secondary,
+        size_t numberOfCellInX, size_t numberOfCellInY);
+
+    std::string getName() const override { return m_Primary->getName() + " / " + m_Secondary->getName(); }
+    bool hasDiverged() const { return m_Diverged; }
+
+    void inject(const std::vector<Injection>& injections) override;
+    void step() override;
+    void finish() override;
+    void count(uint64_t counts[3]) override { m_Primary->count(counts); }
+
+    const CellState* getStates() override { return m_Primary->getStates(); }
+    void exportStates(CellState* states) override { m_Primary->exportStates(states); }
+    void importStates(const CellState* states) override;
+    void setActivityTracking(bool enabled) override;
+
+    StageProfiler* getProfiler() override { return m_Primary->getProfiler(); }
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "EventProfiler.h"
+
+#include "OpenCLWrapper.h"
+
+EventProfiler::~EventProfiler()
+{
+    clear();
+}
+
+void EventProfiler::clear()
+{
+    for (const PendingEvent& pending : m_Pending)
+        CL_ASSERT(clReleaseEvent(pending.Event));
+    m_Pending.clear();
+}
+
+void EventProfiler::track(const char* name, cl_event event, size_t bytes)
+{
+    if (!m_Enabled || !event)
+        return;
+
+    CL_ASSERT(clRetainEvent(event));
+    m_Pending.push_back({ getStage(name), event, bytes });
+}
+
+void EventProfiler::collect()
+{
+    size_t remaining = 0;
+    for (const PendingEvent& pending : m_Pending)
+    {
+        cl_int status = CL_COMPLETE;
+        CL_ASSERT(clGetEventInfo(pending.Event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL));
+        if (status != CL_COMPLETE)
+        {
+            m_Pending[remaining++] = pending;
+            continue;
+        }
+
+        cl_ulong queued = 0;
+        cl_ulong submit = 0;
+        cl_ulong start = 0;
+        cl_ulong end = 0;
+        CL_ASSERT(clGetEventProfilingInfo(pending.Event, CL_PROFILING_COMMAND_QUEUED, sizeof(queued), &queued, NULL));
+        CL_ASSERT(clGetEventProfilingInfo(pending.Event, CL_PROFILING_COMMAND_SUBMIT, sizeof(submit), &submit, NULL));
+        CL_ASSERT(clGetEventProfilingInfo(pending.Event, CL_PROFILING_COMMAND_START, sizeof(start), &start, NULL));
+        CL_ASSERT(clGetEventProfilingInfo(pending.Event, CL_PROFILING_COMMAND_END, sizeof(end), &end, NULL));
+        CL_ASSERT(clReleaseEvent(pending.Event));
+
+        addSample(pending.Stage, (double)(end - start) * 1e-6, (double)(submit - queued) * 1e-6, (double)(start - submit) * 1e-6, pending.Bytes);
+    }
+    m_Pending.resize(remaining);
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <CL/cl.h>
+
+#include <vector>
+
+#include "StageProfiler.h"
+
+// Times OpenCL commands through their events, the queue has to be created with CL_QUEUE_PROFILING_ENABLE
+class EventProfiler : public StageProfiler
+{
+private:
+    struct PendingEvent
+    {
+        size_t Stage;
+        cl_event Event;
+        size_t Bytes;
+    };
+
+    std::vector<PendingEvent> m_Pending;
+
+public:
+    ~EventProfiler();
+
+    // Releases the commands that were not timed yet, before their context goes away
+    void clear();
+
+    // The event is retained until it completed and was timed, the caller keeps its own reference
+    void track(const char* name, cl_event event, size_t bytes);
+    // Times every tracked command that completed, the others are kept for the next collection
+    void collect();
+};
\ No newline at end of file
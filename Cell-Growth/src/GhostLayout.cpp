@@ -0,0 +1,64 @@
+#include "GhostLayout.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool parseBorderFill(const std::string& name, BorderFill& fill)
+{
+    if (name == "empty")
+        fill = BorderFill::EMPTY;
+    else if (name == "cancer")
+        fill = BorderFill::CANCER;
+    else
+        return false;
+    return true;
+}
+
+GhostLayout::GhostLayout(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition) :
+    NumberOfCellX(numberOfCellInX),
+    NumberOfCellY(numberOfCellInY),
+    RowsPerPartition(std::max(rowsPerPartition, (size_t)1)),
+    Stride(numberOfCellInX + 2),
+    NumberOfRows(getRow(numberOfCellInY - 1) + 2),
+    NumberOfCell(Stride * NumberOfRows)
+{
+}
+
+size_t GhostLayout::getSourceRow(size_t y, int direction) const
+{
+    // Unsigned wrap around makes the rows before the first one out of range too
+    size_t sourceY = y - NeighborOffsetY[direction];
+    return sourceY < NumberOfCellY ? getRow(sourceY) : getRow(y) - NeighborOffsetY[direction];
+}
+
+ptrdiff_t GhostLayout::getSourceOffset(size_t y, int direction) const
+{
+    ptrdiff_t rows = (ptrdiff_t)getSourceRow(y, direction) - (ptrdiff_t)getRow(y);
+    return rows * (ptrdiff_t)Stride - NeighborOffsetX[direction];
+}
+
+void GhostLayout::fillGhosts(uint8_t* cells, uint8_t border, uint8_t seam) const
+{
+    memset(cells, border, Stride);
+    memset(cells + (NumberOfRows - 1) * Stride, border, Stride);
+    for (size_t y = 0; y < NumberOfCellY; y++)
+    {
+        uint8_t* row = cells + getRow(y) * Stride;
+        row[0] = border;
+        row[Stride - 1] = border;
+        if ((y + 1) % RowsPerPartition == 0 && y + 1 < NumberOfCellY)
+            memset(row + Stride, seam, Stride);
+    }
+}
+
+void GhostLayout::pack(const CellState* states, CellState* cells) const
+{
+    for (size_t y = 0; y < NumberOfCellY; y++)
+        memcpy(cells + getIndex(0, y), states + y * NumberOfCellX, NumberOfCellX * sizeof(CellState));
+}
+
+void GhostLayout::unpack(const CellState* cells, CellState* states) const
+{
+    for (size_t y = 0; y < NumberOfCellY; y++)
+        memcpy(states + y * NumberOfCellX, cells + getIndex(0, y), NumberOfCellX * sizeof(CellState));
+}
\ No newline at end of file
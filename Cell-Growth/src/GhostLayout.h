@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "CellState.h"
+
+// What the cells on the border of the grid see beyond it
+enum class BorderFill
+{
+    // Nothing, the neighbors outside of the grid are never counted
+    EMPTY,
+    // Cancer cells that never change, the grid is surrounded by the tumour
+    CANCER
+};
+
+// Void cells are neither a type nor cured, they are never counted, never move and never change
+static constexpr CellState VoidCell = 0xFF;
+
+// A cancer fill is counted as cancer and never cured, the border cells resolve to themselves
+inline CellState getBorderCell(BorderFill fill) { return fill == BorderFill::CANCER ? (CellState)CellType::CANCER : VoidCell; }
+
+// "empty" or "cancer", false for anything else
+bool parseBorderFill(const std::string& name, BorderFill& fill);
+
+// Grid stored with a ring of ghost cells around it and a ghost row between two partitions
+// Every cell sees its eight neighbors at the same offsets, the ghost cells are never stepped
+// The ring holds the border fill, the rows between the partitions are void so that neighbors are never counted across them
+// Medecine still moves across a seam, its source is the cell on the other side of the ghost row
+class GhostLayout
+{
+public:
+    const size_t NumberOfCellX;
+    const size_t NumberOfCellY;
+    const size_t RowsPerPartition;
+    // One ghost column on each side of the rows
+    const size_t Stride;
+    // Rows and cells of the padded grid, ghosts included
+    const size_t NumberOfRows;
+    const size_t NumberOfCell;
+
+public:
+    GhostLayout(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition);
+
+    size_t getRow(size_t y) const { return y + y / RowsPerPartition + 1; }
+    size_t getIndex(size_t x, size_t y) const { return getRow(y) * Stride + x + 1; }
+    ptrdiff_t getOffset(int direction) const { return NeighborOffsetY[direction] * (ptrdiff_t)Stride + NeighborOffsetX[direction]; }
+    // Row and offset from a cell of the row to the cell medecine moving in the direction comes from
+    // Sources outside of the grid are read from its ghost ring, which is never medecine
+    size_t getSourceRow(size_t y, int direction) const;
+    ptrdiff_t getSourceOffset(size_t y, int direction) const;
+
+    // The ring and the seams are set apart, the resolved cells use the same values as the states and the consumed cells none
+    void fillGhosts(uint8_t* cells, uint8_t border, uint8_t seam) const;
+    void pack(const CellState* states, CellState* cells) const;
+    void unpack(const CellState* cells, CellState* states) const;
+};
\ No newline at end of file
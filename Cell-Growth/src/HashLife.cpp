@@ -0,0 +1,318 @@
+#include "HashLife.h"
+
+#include <algorithm>
+
+HashLife::HashLife(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border) :
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCellY(numberOfCellInY),
+    m_RowsPerPartition(std::max(rowsPerPartition, (size_t)1)),
+    m_BorderCell(border == BorderFill::CANCER ? s_CancerBorderCell : s_VoidCell),
+    m_ResolvedBorderCell(getBorderCell(border))
+{
+    while (((size_t)1 << m_GridLevel) < std::max(m_NumberOfCellX, m_NumberOfCellY))
+        m_GridLevel++;
+}
+
+void HashLife::clear()
+{
+    m_Nodes.clear();
+    m_NodeIds.clear();
+    m_Results.clear();
+    m_BorderNodes.clear();
+}
+
+uint32_t HashLife::getNode(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se, unsigned int level)
+{
+    Node node = { { nw, ne, sw, se }, level };
+    auto it = m_NodeIds.find(node);
+    if (it != m_NodeIds.end())
+        return it->second;
+
+    uint32_t id = (uint32_t)m_Nodes.size();
+    m_Nodes.push_back(node);
+    m_NodeIds.emplace(node, id);
+    if (m_Bounded && isFull())
+        m_Overflow = true;
+    return id;
+}
+
+uint32_t HashLife::getBorderNode(unsigned int level)
+{
+    if (level == 0)
+        return m_BorderCell;
+
+    while (m_BorderNodes.size() < level)
+    {
+        uint32_t child = m_BorderNodes.empty() ? m_BorderCell : m_BorderNodes.back();
+        m_BorderNodes.push_back(getNode(child, child, child, child, (unsigned int)m_BorderNodes.size() + 1));
+    }
+    return m_BorderNodes[level - 1];
+}
+
+uint32_t HashLife::getCenter(uint32_t node)
+{
+    Node parent = m_Nodes[node];
+    return getNode(m_Nodes[parent.Children[0]].Children[3], m_Nodes[parent.Children[1]].Children[2],
+        m_Nodes[parent.Children[2]].Children[1], m_Nodes[parent.Children[3]].Children[0], parent.Level - 1);
+}
+
+uint32_t HashLife::build(const CellState* states, unsigned int level, int64_t x, int64_t y)
+{
+    int64_t size = (int64_t)1 << level;
+    if (x >= (int64_t)m_NumberOfCellX || y >= (int64_t)m_NumberOfCellY || x + size <= 0 || y + size <= 0)
+        return getBorderNode(level);
+
+    if (level == 0)
+    {
+        // Neighbors across a seam are not counted, the flags keep the rules the same everywhere in the tree
+        // The first and last rows of the grid see the border
+        uint8_t cell = states[(size_t)y * m_NumberOfCellX + (size_t)x];
+        if (y > 0 && (size_t)y % m_RowsPerPartition == 0)
+            cell |= s_FirstRowFlag;
+        if ((size_t)y + 1 < m_NumberOfCellY && ((size_t)y + 1) % m_RowsPerPartition == 0)
+            cell |= s_LastRowFlag;
+        return cell;
+    }
+
+    int64_t half = size / 2;
+    return getNode(build(states, level - 1, x, y), build(states, level - 1, x + half, y),
+        build(states, level - 1, x, y + half), build(states, level - 1, x + half, y + half), level);
+}
+
+uint32_t HashLife::buildBlock(const uint8_t* cells, size_t stride, unsigned int level, size_t x, size_t y)
+{
+    if (level == 0)
+        return cells[y * stride + x];
+
+    size_t half = (size_t)1 << (level - 1);
+    return getNode(buildBlock(cells, stride, level - 1, x, y), buildBlock(cells, stride, level - 1, x + half, y),
+        buildBlock(cells, stride, level - 1, x, y + half), buildBlock(cells, stride, level - 1, x + half, y + half), level);
+}
+
+void HashLife::write(uint32_t node, unsigned int level, int64_t x, int64_t y, CellState* states) const
+{
+    int64_t size = (int64_t)1 << level;
+    if (x >= (int64_t)m_NumberOfCellX || y >= (int64_t)m_NumberOfCellY || x + size <= 0 || y + size <= 0)
+        return;
+
+    if (level == 0)
+    {
+        states[(size_t)y * m_NumberOfCellX + (size_t)x] = (CellState)(node & s_StateMask);
+        return;
+    }
+
+    int64_t half = size / 2;
+    const Node& children = getChildren(node);
+    write(children.Children[0], level - 1, x, y, states);
+    write(children.Children[1], level - 1, x + half, y, states);
+    write(children.Children[2], level - 1, x, y + half, states);
+    write(children.Children[3], level - 1, x + half, y + half, states);
+}
+
+void HashLife::writeBlock(uint32_t node, unsigned int level, size_t x, size_t y, uint8_t* cells, size_t stride) const
+{
+    if (level == 0)
+    {
+        cells[y * stride + x] = (uint8_t)node;
+        return;
+    }
+
+    size_t half = (size_t)1 << (level - 1);
+    const Node& children = getChildren(node);
+    writeBlock(children.Children[0], level - 1, x, y, cells, stride);
+    writeBlock(children.Children[1], level - 1, x + half, y, cells, stride);
+    writeBlock(children.Children[2], level - 1, x, y + half, cells, stride);
+    writeBlock(children.Children[3], level - 1, x + half, y + half, cells, stride);
+}
+
+uint32_t HashLife::advanceBase(uint32_t node)
+{
+    // Cells near the border of the block see a truncated neighborhood, they are not part of the center
+    constexpr size_t Size = s_BaseSize;
+    uint8_t cells[Size * Size];
+    writeBlock(node, s_BaseLevel, 0, 0, cells, Size);
+
+    auto inPartition = [&cells](size_t x, size_t y, int direction)
+    {
+        size_t neighborX = x + NeighborOffsetX[direction];
+        size_t neighborY = y + NeighborOffsetY[direction];
+        uint8_t cell = cells[y * Size + x];
+        return neighborX < Size && neighborY < Size
+            && !(NeighborOffsetY[direction] < 0 && (cell & s_FirstRowFlag))
+            && !(NeighborOffsetY[direction] > 0 && (cell & s_LastRowFlag));
+    };
+
+    // The border resolves to itself, void cells to a value that is neither a type nor cured
+    uint8_t resolved[Size * Size];
+    for (size_t y = 0; y < Size; y++)
+    {
+        for (size_t x = 0; x < Size; x++)
+        {
+            uint8_t cell = cells[y * Size + x];
+            uint8_t type = cell & CellTypeMask;
+            resolved[y * Size + x] = cell == m_BorderCell ? m_ResolvedBorderCell : type;
+            if (cell == m_BorderCell || (type != (uint8_t)CellType::HEALTHY && type != (uint8_t)CellType::CANCER))
+                continue;
+
+            uint8_t target = type == (uint8_t)CellType::HEALTHY ? (uint8_t)CellType::CANCER : (uint8_t)CellType::MEDECINE;
+            int count = 0;
+            for (int j = 0; j < 8; j++)
+            {
+                if (inPartition(x, y, j)
+                    && (cells[(y + NeighborOffsetY[j]) * Size + x + NeighborOffsetX[j]] & CellTypeMask) == target)
+                    count++;
+            }
+            if (type == (uint8_t)CellType::HEALTHY && count >= CancerThreshold)
+                resolved[y * Size + x] = (uint8_t)CellType::CANCER;
+            else if (type == (uint8_t)CellType::CANCER && count >= CureThreshold)
+                resolved[y * Size + x] = CellCured;
+        }
+    }
+
+    bool consumed[Size * Size];
+    for (size_t y = 0; y < Size; y++)
+    {
+        for (size_t x = 0; x < Size; x++)
+        {
+            bool nextToCured = false;
+            for (int j = 0; j < 8 && !nextToCured; j++)
+                nextToCured = inPartition(x, y, j) && resolved[(y + NeighborOffsetY[j]) * Size + x + NeighborOffsetX[j]] == CellCured;
+            consumed[y * Size + x] = resolved[y * Size + x] == (uint8_t)CellType::MEDECINE && nextToCured;
+        }
+    }
+
+    constexpr size_t CenterSize = Size / 2;
+    constexpr size_t Margin = Size / 4;
+    uint8_t center[CenterSize * CenterSize];
+    for (size_t y = Margin; y < Margin + CenterSize; y++)
+    {
+        for (size_t x = Margin; x < Margin + CenterSize; x++)
+        {
+            size_t i = y * Size + x;
+            uint8_t& next = center[(y - Margin) * CenterSize + x - Margin];
+            if (cells[i] == m_BorderCell)
+            {
+                next = m_BorderCell;
+                continue;
+            }
+
+            // Medecine that is not consumed restores the cell it was covering and keeps others from moving in
+            uint8_t flags = cells[i] & ~s_StateMask;
+            if (resolved[i] == (uint8_t)CellType::MEDECINE && !consumed[i])
+            {
+                next = (uint8_t)getPreviousCellType(cells[i] & s_StateMask) | flags;
+                continue;
+            }
+
+            // Medecine moving into this cell, the first neighbor in offset order wins, the border is never medecine
+            CellType type = resolved[i] >= (uint8_t)CellType::MEDECINE ? CellType::HEALTHY : (CellType)resolved[i];
+            CellState nextState = (CellState)type;
+            for (int j = 0; j < 8; j++)
+            {
+                size_t source = (y - NeighborOffsetY[j]) * Size + x - NeighborOffsetX[j];
+                CellState sourceState = cells[source] & s_StateMask;
+                if (getCellType(sourceState) == CellType::MEDECINE && getCellDirection(sourceState) == j && !consumed[source])
+                {
+                    nextState = packMedecine(type, j);
+                    break;
+                }
+            }
+            next = nextState | flags;
+        }
+    }
+    return buildBlock(center, CenterSize, s_BaseLevel - 1, 0, 0);
+}
+
+uint32_t HashLife::advance(uint32_t node, unsigned int step)
+{
+    // Results computed once the cache is full are dropped with it, any node will do
+    if (m_Overflow)
+        return node;
+
+    unsigned int level = getLevel(node);
+    if (level == s_BaseLevel)
+        return advanceBase(node);
+
+    uint64_t key = (uint64_t)node << 6 | step;
+    auto it = m_Results.find(key);
+    if (it != m_Results.end())
+        return it->second;
+
+    // Nine overlapping nodes of the level below, the nodes are copied since building new ones may move them
+    Node parent = m_Nodes[node];
+    Node nw = m_Nodes[parent.Children[0]];
+    Node ne = m_Nodes[parent.Children[1]];
+    Node sw = m_Nodes[parent.Children[2]];
+    Node se = m_Nodes[parent.Children[3]];
+    uint32_t subnodes[9] = {
+        parent.Children[0],
+        getNode(nw.Children[1], ne.Children[0], nw.Children[3], ne.Children[2], level - 1),
+        parent.Children[1],
+        getNode(nw.Children[2], nw.Children[3], sw.Children[0], sw.Children[1], level - 1),
+        getNode(nw.Children[3], ne.Children[2], sw.Children[1], se.Children[0], level - 1),
+        getNode(ne.Children[2], ne.Children[3], se.Children[0], se.Children[1], level - 1),
+        parent.Children[2],
+        getNode(sw.Children[1], se.Children[0], sw.Children[3], se.Children[2], level - 1),
+        parent.Children[3] };
+
+    // The largest step of a node takes two half steps of the level below, smaller ones take their centers unchanged
+    bool fullStep = step + s_BaseLevel == level;
+    unsigned int subStep = fullStep ? step - 1 : step;
+    for (uint32_t& subnode : subnodes)
+        subnode = fullStep ? advance(subnode, subStep) : getCenter(subnode);
+
+    uint32_t quadrants[4];
+    quadrants[0] = advance(getNode(subnodes[0], subnodes[1], subnodes[3], subnodes[4], level - 1), subStep);
+    quadrants[1] = advance(getNode(subnodes[1], subnodes[2], subnodes[4], subnodes[5], level - 1), subStep);
+    quadrants[2] = advance(getNode(subnodes[3], subnodes[4], subnodes[6], subnodes[7], level - 1), subStep);
+    quadrants[3] = advance(getNode(subnodes[4], subnodes[5], subnodes[7], subnodes[8], level - 1), subStep);
+    uint32_t result = getNode(quadrants[0], quadrants[1], quadrants[2], quadrants[3], level - 1);
+    if (m_Overflow)
+        return result;
+
+    m_Results.emplace(key, result);
+    if (m_Bounded && isFull())
+        m_Overflow = true;
+    return result;
+}
+
+bool HashLife::jump(CellState* states, unsigned int log2Generations, bool bounded)
+{
+    m_Bounded = bounded;
+    m_Overflow = false;
+
+    // The grid sits in the center half of a root padded with the border, which is what a jump returns
+    unsigned int level = std::max(m_GridLevel + 1, log2Generations + s_BaseLevel);
+    int64_t offset = (int64_t)1 << (level - 2);
+    uint32_t root = build(states, level, -offset, -offset);
+    uint32_t result = advance(root, log2Generations);
+    if (m_Overflow)
+        return false;
+
+    write(result, level - 1, 0, 0, states);
+    return true;
+}
+
+void HashLife::advance(CellState* states, unsigned int log2Generations)
+{
+    if (isFull())
+        clear();
+    if (jump(states, log2Generations, true))
+        return;
+
+    // The cache filled up during the jump, it is started again with an empty one
+    clear();
+    if (jump(states, log2Generations, true))
+        return;
+
+    // Even an empty cache cannot hold the jump, it is made of two jumps of half as many generations
+    // A single generation is always computed, the tree of a large grid alone may not fit in the cache
+    clear();
+    if (log2Generations == 0)
+    {
+        jump(states, 0, false);
+        return;
+    }
+    advance(states, log2Generations - 1);
+    advance(states, log2Generations - 1);
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "CellState.h"
+#include "GhostLayout.h"
+
+// Gosper's HashLife on the cell rules, the grid is a quadtree of shared nodes whose future is memoized
+// Without injections the rules are deterministic, a node of 2^n cells gives its center 2^(n-4) generations later
+// Cells depend on the cells up to three away in a generation, so the light cone of a node is a quarter of its side
+class HashLife
+{
+public:
+    // Most nodes and results the cache holds, a jump that needs more is restarted with an empty cache, then split in two
+    static constexpr size_t MaxNumberOfNodes = 1 << 22;
+
+private:
+    // Leaves are the cells themselves, their state with flags for the partition seams inside of the grid around them
+    // Cells outside of the grid hold the border, they never move and never change
+    static constexpr uint8_t s_VoidCell = CellCured;
+    // A cancer border is told apart from the cancer cells by the bit only medecine uses
+    static constexpr uint8_t s_CancerBorderCell = (uint8_t)CellType::CANCER | 1 << CellPreviousTypeShift;
+    static constexpr uint8_t s_FirstRowFlag = 1 << 6;
+    static constexpr uint8_t s_LastRowFlag = 1 << 7;
+    static constexpr uint8_t s_StateMask = 0x3F;
+
+    // The smallest node stepped cell by cell, 16x16 cells give their 8x8 center one generation later
+    static constexpr unsigned int s_BaseLevel = 4;
+    static constexpr size_t s_BaseSize = (size_t)1 << s_BaseLevel;
+
+    // Children in NW, NE, SW, SE order, they are cells on the first level
+    struct Node
+    {
+        uint32_t Children[4];
+        uint32_t Level;
+
+        bool operator==(const Node& other) const
+        {
+            return Level == other.Level && Children[0] == other.Children[0] && Children[1] == other.Children[1]
+                && Children[2] == other.Children[2] && Children[3] == other.Children[3];
+        }
+    };
+
+    struct NodeHash
+    {
+        size_t operator()(const Node& node) const
+        {
+            uint64_t hash = node.Level;
+            for (uint32_t child : node.Children)
+                hash = (hash ^ child) * 0x100000001B3ull;
+            return (size_t)(hash ^ (hash >> 32));
+        }
+    };
+
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCellY;
+    const size_t m_RowsPerPartition;
+    // Leaf of the cells outside of the grid and what they resolve to
+    const uint8_t m_BorderCell;
+    const uint8_t m_ResolvedBorderCell;
+    // Smallest level whose node covers the grid
+    unsigned int m_GridLevel = s_BaseLevel;
+
+    std::vector<Node> m_Nodes;
+    std::unordered_map<Node, uint32_t, NodeHash> m_NodeIds;
+    // Node advanced by 2^step generations, keyed by the node and the step
+    std::unordered_map<uint64_t, uint32_t> m_Results;
+    std::vector<uint32_t> m_BorderNodes;
+    // Set once a bounded jump filled the cache, the recursion then unwinds and the jump is started again
+    bool m_Bounded = true;
+    bool m_Overflow = false;
+
+private:
+    bool isFull() const { return m_Nodes.size() > MaxNumberOfNodes || m_Results.size() > MaxNumberOfNodes; }
+    uint32_t getNode(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se, unsigned int level);
+    uint32_t getBorderNode(unsigned int level);
+    const Node& getChildren(uint32_t node) const { return m_Nodes[node]; }
+    unsigned int getLevel(uint32_t node) const { return m_Nodes[node].Level; }
+    uint32_t getCenter(uint32_t node);
+
+    uint32_t build(const CellState* states, unsigned int level, int64_t x, int64_t y);
+    uint32_t buildBlock(const uint8_t* cells, size_t stride, unsigned int level, size_t x, size_t y);
+    void write(uint32_t node, unsigned int level, int64_t x, int64_t y, CellState* states) const;
+    void writeBlock(uint32_t node, unsigned int level, size_t x, size_t y, uint8_t* cells, size_t stride) const;
+
+    uint32_t advance(uint32_t node, unsigned int step);
+    uint32_t advanceBase(uint32_t node);
+    // False when a bounded jump filled the cache, the states are then left unchanged
+    bool jump(CellState* states, unsigned int log2Generations, bool bounded);
+
+public:
+    HashLife(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border = BorderFill::EMPTY);
+
+    // Advances the states by 2^log2Generations generations in place
+    void advance(CellState* states, unsigned int log2Generations);
+
+    size_t getNumberOfNodes() const { return m_Nodes.size(); }
+    void clear();
+};
\ No newline at end of file
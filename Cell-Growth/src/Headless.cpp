@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "Simulation.h"
+#include "SimulationLog.h"
+
+namespace {
+
+struct ScheduledInjection
+{
+    uint64_t Generation;
+    size_t X;
+    size_t Y;
+    int NumberOfCells;
+};
+
+// "generation,x,y" or "generation,x,y,cells", the number of cells is the one of a click and defaults to the largest
+bool parseInjection(const std::string& text, ScheduledInjection& injection)
+{
+    unsigned long long generation;
+    unsigned long long x;
+    unsigned long long y;
+    int numberOfCells = 8;
+    std::string fields = text;
+    std::replace(fields.begin(), fields.end(), ',', ' ');
+    std::istringstream stream(fields);
+    if (!(stream >> generation >> x >> y))
+        return false;
+
+    stream >> numberOfCells;
+    injection = { generation, (size_t)x, (size_t)y, std::min(std::max(numberOfCells, 1), 8) };
+    return true;
+}
+
+bool loadSchedule(const std::string& path, std::vector<ScheduledInjection>& schedule)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        SIM_ERROR("Cannot open injection schedule: {0}", path);
+        return false;
+    }
+
+    // One injection per line, lines starting with # are comments
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        ScheduledInjection injection;
+        if (!parseInjection(line, injection))
+        {
+            SIM_ERROR("Invalid injection in {0}: {1}", path, line);
+            return false;
+        }
+        schedule.push_back(injection);
+    }
+    return true;
+}
+
+void printCounts(const Simulation& simulation)
+{
+    printf("%llu,%llu,%llu,%llu\n", (unsigned long long)simulation.getGeneration(), (unsigned long long)simulation.getNumberOfCancerCells(),
+        (unsigned long long)simulation.getNumberOfHealthyCells(), (unsigned long long)simulation.getNumberOfMedecineCells());
+    fflush(stdout);
+}
+
+}
+
+// Usage: Cell-Growth-Headless [--backend opencl|cpu|bitboard|mapped|reference] [--device gpu|cpu|any|index] [--cross-check backend]
+//     [--mapped-file path] [--resident-mb megabytes] [--border empty|cancer] [--seed n] [--cancer fraction] [--exact-count]
+//     [--generations n] [--report every] [--inject generation,x,y[,cells]]... [--schedule file] [cells in x] [cells in y]
+// Counts are printed as CSV on the standard output, the initial and final generations and every report in between
+int main(int argc, char** argv)
+{
+    size_t numberOfCellInX = 1024;
+    size_t numberOfCellInY = 1024;
+    BackendSettings settings;
+    settings.Backend = "cpu";
+    uint64_t seed = std::random_device()();
+    double cancerDensity = -1.0;
+    bool exactCount = false;
+    uint64_t numberOfGenerations = 1000;
+    uint64_t reportPeriod = 0;
+    std::vector<ScheduledInjection> schedule;
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--profile") == 0)
+            settings.Profiling = true;
+        else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc)
+            settings.Backend = argv[++i];
+        else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc)
+            settings.Device = argv[++i];
+        else if (strcmp(argv[i], "--cross-check") == 0 && i + 1 < argc)
+            settings.CrossCheck = argv[++i];
+        else if (strcmp(argv[i], "--mapped-file") == 0 && i + 1 < argc)
+            settings.MappedFile = argv[++i];
+        else if (strcmp(argv[i], "--resident-mb") == 0 && i + 1 < argc)
+            settings.ResidentMegabytes = (size_t)std::max(atoll(argv[++i]), 1LL);
+        else if (strcmp(argv[i], "--border") == 0 && i + 1 < argc)
+        {
+            if (!parseBorderFill(argv[++i], settings.Border))
+            {
+                SIM_ERROR("Invalid border: {0}", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--cancer") == 0 && i + 1 < argc)
+            cancerDensity = std::min(std::max(atof(argv[++i]), 0.0), 1.0);
+        else if (strcmp(argv[i], "--exact-count") == 0)
+            exactCount = true;
+        else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc)
+            numberOfGenerations = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc)
+            reportPeriod = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--schedule") == 0 && i + 1 < argc)
+        {
+            if (!loadSchedule(argv[++i], schedule))
+                return 1;
+        }
+        else if (strcmp(argv[i], "--inject") == 0 && i + 1 < argc)
+        {
+            ScheduledInjection injection;
+            if (!parseInjection(argv[++i], injection))
+            {
+                SIM_ERROR("Invalid injection: {0}", argv[i]);
+                return 1;
+            }
+            schedule.push_back(injection);
+        }
+        else if (argv[i][0] != '\0' && strspn(argv[i], "0123456789") == strlen(argv[i]) && sizes.size() < 2)
+            sizes.push_back((size_t)std::max(atoll(argv[i]), 1LL));
+        else
+        {
+            SIM_ERROR("Unknown argument: {0}", argv[i]);
+            return 1;
+        }
+    }
+    if (sizes.size() > 0)
+        numberOfCellInX = numberOfCellInY = sizes[0];
+    if (sizes.size() > 1)
+        numberOfCellInY = sizes[1];
+
+    Simulation simulation(numberOfCellInX, numberOfCellInY, settings, seed, cancerDensity, exactCount);
+    std::stable_sort(schedule.begin(), schedule.end(),
+        [](const ScheduledInjection& a, const ScheduledInjection& b) { return a.Generation < b.Generation; });
+    size_t nextInjection = 0;
+
+    printf("generation,cancer,healthy,medecine\n");
+    printCounts(simulation);
+
+    // Generations are stepped back to back, the backend is only waited on to count them
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t generation = 0; generation < numberOfGenerations; generation++)
+    {
+        std::vector<Injection> injections;
+        for (; nextInjection < schedule.size() && schedule[nextInjection].Generation <= generation; nextInjection++)
+        {
+            const ScheduledInjection& injection = schedule[nextInjection];
+            if (injection.X < simulation.NumberOfCellX && injection.Y < simulation.NumberOfCellY)
+                injections.push_back({ injection.Y * simulation.NumberOfCellX + injection.X, injection.NumberOfCells });
+            else
+                SIM_WARN("Injection outside of the grid: {0},{1}", injection.X, injection.Y);
+        }
+        if (!injections.empty())
+            simulation.inject(injections);
+
+        simulation.step();
+        if (reportPeriod > 0 && (generation + 1) % reportPeriod == 0 && generation + 1 < numberOfGenerations)
+        {
+            simulation.finish();
+            printCounts(simulation);
+        }
+    }
+    simulation.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (numberOfGenerations > 0)
+        printCounts(simulation);
+
+    SIM_INFO("{0} generations in {1} s, {2} generations/s, {3} Mcells/s", numberOfGenerations, seconds,
+        seconds > 0.0 ? (double)numberOfGenerations / seconds : 0.0,
+        seconds > 0.0 ? (double)numberOfGenerations * (double)simulation.NumberOfCell / seconds * 1e-6 : 0.0);
+    return simulation.isConsistent() ? 0 : 2;
+}
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "MappedBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+constexpr size_t MappedBackend::s_TileSize;
+constexpr size_t MappedBackend::s_Margin;
+constexpr size_t MappedBackend::s_WindowSize;
+constexpr size_t MappedBackend::s_WindowRows;
+
+MappedBackend::MappedBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border, const std::string& path,
+    size_t residentBytes, bool profiling) :
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCellY(numberOfCellInY),
+    m_NumberOfCell(numberOfCellInX * numberOfCellInY),
+    m_RowsPerPartition(std::max(rowsPerPartition, (size_t)1)),
+    m_BorderCell(getBorderCell(border)),
+    m_Store(numberOfCellInX, numberOfCellInY, path, residentBytes),
+    m_Activity(numberOfCellInX, numberOfCellInY, s_TileSize, s_TileSize)
+{
+    m_TileCounts.assign(m_Store.getNumberOfTiles() * 3, 0);
+    m_Profiler.setEnabled(profiling);
+}
+
+bool MappedBackend::inPartition(size_t x, size_t y, int direction) const
+{
+    // Unsigned wrap around makes the cells before the first row or column out of range too
+    size_t neighborX = x + NeighborOffsetX[direction];
+    size_t neighborY = y + NeighborOffsetY[direction];
+    return neighborX < m_NumberOfCellX && neighborY < m_NumberOfCellY
+        && neighborY / m_RowsPerPartition == y / m_RowsPerPartition;
+}
+
+size_t MappedBackend::gatherWindow(const Neighborhood& neighborhood, CellState* window, size_t* rows, bool* ghostRows) const
+{
+    size_t tileX = neighborhood.Tile % m_Store.getNumberOfTileX();
+    size_t tileY = neighborhood.Tile / m_Store.getNumberOfTileX();
+    int64_t originX = (int64_t)(tileX * s_TileSize) - (int64_t)s_Margin;
+    int64_t originY = (int64_t)(tileY * s_TileSize) - (int64_t)s_Margin;
+
+    // Columns of the window taken from the tiles on the left, in the middle and on the right
+    const size_t begins[4] = { 0, s_Margin, s_Margin + s_TileSize, s_WindowSize };
+    const size_t sources[3] = { s_TileSize - s_Margin, 0, 0 };
+    size_t end = std::min((size_t)((int64_t)m_NumberOfCellX - originX), s_WindowSize);
+    size_t numberOfRows = 0;
+    for (size_t windowY = 0; windowY < s_WindowSize; windowY++)
+    {
+        // Neighbors are never counted across a void row between two partitions
+        int64_t y = originY + (int64_t)windowY;
+        if (windowY > 0 && y > 0 && y < (int64_t)m_NumberOfCellY && (size_t)y % m_RowsPerPartition == 0)
+        {
+            memset(window + numberOfRows * s_WindowSize, VoidCell, s_WindowSize);
+            ghostRows[numberOfRows++] = true;
+        }
+
+        rows[windowY] = numberOfRows;
+        CellState* row = window + numberOfRows * s_WindowSize;
+        ghostRows[numberOfRows++] = y < 0 || y >= (int64_t)m_NumberOfCellY;
+        if (y < 0 || y >= (int64_t)m_NumberOfCellY)
+        {
+            memset(row, m_BorderCell, s_WindowSize);
+            continue;
+        }
+
+        size_t tileRow = (size_t)y / s_TileSize + 1 - tileY;
+        size_t localY = (size_t)y % s_TileSize;
+        for (size_t column = 0; column < 3; column++)
+        {
+            const CellState* cells = neighborhood.Front[tileRow * 3 + column];
+            if (cells)
+                memcpy(row + begins[column], cells + localY * s_TileSize + sources[column], begins[column + 1] - begins[column]);
+            else
+                memset(row + begins[column], m_BorderCell, begins[column + 1] - begins[column]);
+        }
+        // Tiles on the right border hold cells past the grid
+        memset(row + end, m_BorderCell, s_WindowSize - end);
+    }
+    return numberOfRows;
+}
+
+void MappedBackend::stepTile(const Neighborhood& neighborhood)
+{
+    // Scratch of the worker, the windows are too large for the stack
+    constexpr size_t Size = s_WindowSize;
+    thread_local std::vector<CellState> window(s_WindowRows * Size);
+    thread_local std::vector<uint8_t> resolved(s_WindowRows * Size);
+    thread_local std::vector<uint8_t> consumed(s_WindowRows * Size);
+    size_t rows[Size];
+    bool ghostRows[s_WindowRows];
+    size_t numberOfRows = gatherWindow(neighborhood, window.data(), rows, ghostRows);
+
+    // Columns of the window that are cells of the grid, the others are ghosts like the rows outside of the grid and between partitions
+    TileBounds bounds = m_Activity.getTileBounds(neighborhood.Tile);
+    size_t firstColumn = bounds.BeginX < s_Margin ? s_Margin - bounds.BeginX : 0;
+    size_t endColumn = std::min(m_NumberOfCellX + s_Margin - bounds.BeginX, Size);
+    ptrdiff_t offsets[8];
+    for (int j = 0; j < 8; j++)
+        offsets[j] = NeighborOffsetY[j] * (ptrdiff_t)Size + NeighborOffsetX[j];
+
+    // Each pass covers one row and one column less on every side than the one before
+    for (size_t y = 1; y < numberOfRows - 1; y++)
+    {
+        for (size_t x = 1; x < Size - 1; x++)
+        {
+            // Ghosts resolve to themselves, void cells are neither a type nor cured and a cancer border is never cured
+            size_t i = y * Size + x;
+            uint8_t type = window[i] & CellTypeMask;
+            if (ghostRows[y] || x < firstColumn || x >= endColumn)
+            {
+                resolved[i] = window[i];
+                continue;
+            }
+
+            resolved[i] = type;
+            if (type != (uint8_t)CellType::HEALTHY && type != (uint8_t)CellType::CANCER)
+                continue;
+
+            uint8_t target = type == (uint8_t)CellType::HEALTHY ? (uint8_t)CellType::CANCER : (uint8_t)CellType::MEDECINE;
+            int count = 0;
+            for (int j = 0; j < 8; j++)
+            {
+                if ((window[i + offsets[j]] & CellTypeMask) == target)
+                    count++;
+            }
+            if (type == (uint8_t)CellType::HEALTHY && count >= CancerThreshold)
+                resolved[i] = (uint8_t)CellType::CANCER;
+            else if (type == (uint8_t)CellType::CANCER && count >= CureThreshold)
+                resolved[i] = CellCured;
+        }
+    }
+
+    for (size_t y = 2; y < numberOfRows - 2; y++)
+    {
+        for (size_t x = 2; x < Size - 2; x++)
+        {
+            size_t i = y * Size + x;
+            bool nextToCured = false;
+            for (int j = 0; j < 8 && !nextToCured; j++)
+                nextToCured = resolved[i + offsets[j]] == CellCured;
+            consumed[i] = resolved[i] == (uint8_t)CellType::MEDECINE && nextToCured;
+        }
+    }
+
+    uint64_t counts[3] = { 0, 0, 0 };
+    bool changed = false;
+    for (size_t y = 0; y < bounds.EndY - bounds.BeginY; y++)
+    {
+        // Medecine moves across the seams, its sources skip the void rows
+        ptrdiff_t sourceOffsets[8];
+        for (int j = 0; j < 8; j++)
+            sourceOffsets[j] = ((ptrdiff_t)rows[y + s_Margin - NeighborOffsetY[j]] - (ptrdiff_t)rows[y + s_Margin]) * (ptrdiff_t)Size - NeighborOffsetX[j];
+
+        for (size_t x = 0; x < bounds.EndX - bounds.BeginX; x++)
+        {
+            size_t i = rows[y + s_Margin] * Size + x + s_Margin;
+            CellState state = window[i];
+
+            // Medecine that is not consumed restores the cell it was covering and keeps others from moving in
+            CellState nextState;
+            if (resolved[i] == (uint8_t)CellType::MEDECINE && !consumed[i])
+            {
+                nextState = (CellState)getPreviousCellType(state);
+            }
+            else
+            {
+                // Medecine moving into this cell, the first neighbor in offset order wins, ghosts are never medecine
+                CellType type = resolved[i] >= (uint8_t)CellType::MEDECINE ? CellType::HEALTHY : (CellType)resolved[i];
+                nextState = (CellState)type;
+                for (int j = 0; j < 8; j++)
+                {
+                    size_t source = i + sourceOffsets[j];
+                    if (getCellType(window[source]) == CellType::MEDECINE && getCellDirection(window[source]) == j && !consumed[source])
+                    {
+                        nextState = packMedecine(type, j);
+                        break;
+                    }
+                }
+            }
+            changed |= nextState != state;
+            counts[nextState & CellTypeMask]++;
+            neighborhood.Back[y * s_TileSize + x] = nextState;
+        }
+    }
+
+    for (size_t type = 0; type < 3; type++)
+        m_TileCounts[neighborhood.Tile * 3 + type] = counts[type];
+    if (changed)
+        m_Activity.markTile(neighborhood.Tile);
+}
+
+void MappedBackend::countTile(size_t tile, const CellState* cells)
+{
+    TileBounds bounds = m_Activity.getTileBounds(tile);
+    uint64_t counts[3] = { 0, 0, 0 };
+    for (size_t y = 0; y < bounds.EndY - bounds.BeginY; y++)
+    {
+        for (size_t x = 0; x < bounds.EndX - bounds.BeginX; x++)
+            counts[cells[y * s_TileSize + x] & CellTypeMask]++;
+    }
+    for (size_t type = 0; type < 3; type++)
+        m_TileCounts[tile * 3 + type] = counts[type];
+}
+
+void MappedBackend::inject(const std::vector<Injection>& injections)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (const Injection& injection : injections)
+    {
+        size_t x = injection.Index % m_NumberOfCellX;
+        size_t y = injection.Index / m_NumberOfCellX;
+        int numberOfCells = getNumberOfInjectedCells(injection);
+        int counter = 0;
+        for (int j = 0; j < 8; j++)
+        {
+            if (!inPartition(x, y, j))
+                continue;
+
+            counter++;
+            if (counter >= numberOfCells)
+                break;
+
+            size_t neighborX = x + NeighborOffsetX[j];
+            size_t neighborY = y + NeighborOffsetY[j];
+            size_t tile = m_Activity.getTile(neighborX, neighborY);
+            CellState& state = m_Store.acquire(m_Front, tile)[neighborY % s_TileSize * s_TileSize + neighborX % s_TileSize];
+            if (getCellType(state) != CellType::MEDECINE)
+            {
+                m_TileCounts[tile * 3 + (state & CellTypeMask)]--;
+                m_TileCounts[tile * 3 + (size_t)CellType::MEDECINE]++;
+                state = packMedecine(getCellType(state), j);
+                m_Activity.markTile(tile);
+            }
+        }
+    }
+    m_Store.trim();
+    m_ViewDirty = true;
+    m_Profiler.record("Inject", start, injections.size() * 8 * sizeof(CellState));
+}
+
+void MappedBackend::step()
+{
+    // Tiles that are skipped hold the same states in both generations, they are never paged in
+    // The rules, the medecine moves and the counts are fused in one pass over each tile window, paging included
+    m_Activity.update();
+    const std::vector<size_t>& tiles = m_Activity.getActiveTiles();
+    auto start = std::chrono::steady_clock::now();
+    size_t numberOfTileX = m_Store.getNumberOfTileX();
+    size_t numberOfTileY = m_Store.getNumberOfTileY();
+    std::vector<Neighborhood> band;
+    for (size_t begin = 0, end = 0; begin < tiles.size(); begin = end)
+    {
+        // Tiles are paged in on this thread, the views are released between rows of tiles once every worker is done with them
+        size_t tileY = tiles[begin] / numberOfTileX;
+        band.clear();
+        for (end = begin; end < tiles.size() && tiles[end] / numberOfTileX == tileY; end++)
+        {
+            Neighborhood neighborhood;
+            neighborhood.Tile = tiles[end];
+            size_t tileX = tiles[end] % numberOfTileX;
+            for (size_t row = 0; row < 3; row++)
+            {
+                for (size_t column = 0; column < 3; column++)
+                {
+                    // Unsigned wrap around puts the tiles before the first row or column outside of the grid
+                    size_t neighborX = tileX + column - 1;
+                    size_t neighborY = tileY + row - 1;
+                    neighborhood.Front[row * 3 + column] = neighborX < numberOfTileX && neighborY < numberOfTileY
+                        ? m_Store.acquire(m_Front, neighborY * numberOfTileX + neighborX) : nullptr;
+                }
+            }
+            neighborhood.Back = m_Store.acquire(m_Front ^ 1, neighborhood.Tile);
+            band.push_back(neighborhood);
+        }
+
+        m_Pool.parallelFor(band.size(), [this, &band](size_t i) { stepTile(band[i]); });
+        m_Store.trim();
+    }
+    m_Profiler.record("Step Tiles", start, tiles.size() * (s_WindowSize * s_WindowSize + s_TileSize * s_TileSize) * sizeof(CellState));
+    m_Front ^= 1;
+    m_ViewDirty = true;
+}
+
+void MappedBackend::count(uint64_t counts[3])
+{
+    counts[0] = counts[1] = counts[2] = 0;
+    for (size_t tile = 0; tile < m_Store.getNumberOfTiles(); tile++)
+    {
+        for (size_t type = 0; type < 3; type++)
+            counts[type] += m_TileCounts[tile * 3 + type];
+    }
+}
+
+const CellState* MappedBackend::getStates()
+{
+    if (m_ViewDirty)
+    {
+        if (m_ViewStates.size() != m_NumberOfCell)
+            m_ViewStates.allocate(m_NumberOfCell);
+        exportStates(m_ViewStates.data());
+        m_ViewDirty = false;
+    }
+    return m_ViewStates.data();
+}
+
+void MappedBackend::exportStates(CellState* states)
+{
+    forEachTile([this, states](size_t, const CellState* cells, const TileBounds& bounds)
+    {
+        for (size_t y = bounds.BeginY; y < bounds.EndY; y++)
+            memcpy(states + y * m_NumberOfCellX + bounds.BeginX, cells + (y - bounds.BeginY) * s_TileSize, bounds.EndX - bounds.BeginX);
+    });
+}
+
+void MappedBackend::importStates(const CellState* states)
+{
+    importRows(0, m_NumberOfCellY, states);
+}
+
+void MappedBackend::importRows(size_t firstRow, size_t numberOfRows, const CellState* states)
+{
+    // Only the tiles holding the rows are paged in, the states start at the first row
+    size_t endRow = std::min(firstRow + numberOfRows, m_NumberOfCellY);
+    size_t numberOfTileX = m_Store.getNumberOfTileX();
+    for (size_t tile = firstRow / s_TileSize * numberOfTileX; tile < m_Store.getNumberOfTiles(); tile++)
+    {
+        TileBounds bounds = m_Activity.getTileBounds(tile);
+        if (bounds.BeginY >= endRow)
+            break;
+
+        CellState* cells = m_Store.acquire(m_Front, tile);
+        for (size_t y = std::max(bounds.BeginY, firstRow); y < std::min(bounds.EndY, endRow); y++)
+        {
+            memcpy(cells + (y - bounds.BeginY) * s_TileSize, states + (y - firstRow) * m_NumberOfCellX + bounds.BeginX,
+                bounds.EndX - bounds.BeginX);
+        }
+        countTile(tile, cells);
+        m_Store.trim();
+    }
+    m_Activity.markAll();
+    m_ViewDirty = true;
+}
\ No newline at end of file
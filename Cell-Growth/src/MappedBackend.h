@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+
+#include "ActivityMap.h"
+#include "AlignedArray.h"
+#include "MappedTileStore.h"
+#include "SimulationBackend.h"
+#include "StageProfiler.h"
+#include "WorkStealingPool.h"
+
+// Native implementation of the kernel rules on a grid kept in a memory-mapped file, for grids larger than memory
+// Active tiles are stepped one row of tiles at a time, so the tiles read around them are those of the rows just above and below
+class MappedBackend : public SimulationBackend
+{
+private:
+    static constexpr size_t s_TileSize = MappedTileStore::TileSize;
+    // A tile is stepped from a window holding the cells up to three away from it
+    static constexpr size_t s_Margin = 3;
+    static constexpr size_t s_WindowSize = s_TileSize + 2 * s_Margin;
+    // The window holds a ghost row between two partitions, there are at most as many as rows of cells
+    static constexpr size_t s_WindowRows = 2 * s_WindowSize;
+
+    // Tiles around a stepped tile in row-major order, nullptr outside of the grid
+    struct Neighborhood
+    {
+        size_t Tile;
+        const CellState* Front[9];
+        CellState* Back;
+    };
+
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCellY;
+    const size_t m_NumberOfCell;
+    const size_t m_RowsPerPartition;
+    // Cells of the window outside of the grid
+    const CellState m_BorderCell;
+    MappedTileStore m_Store;
+    ActivityMap m_Activity;
+    WorkStealingPool m_Pool;
+    StageProfiler m_Profiler;
+
+    size_t m_Front = 0;
+    // Number of cancer, healthy and medecine cells of every tile in the current generation
+    std::vector<uint64_t> m_TileCounts;
+    // Copy of the whole grid for drawing, only made when asked for
+    AlignedArray<CellState> m_ViewStates;
+    bool m_ViewDirty = true;
+
+private:
+    bool inPartition(size_t x, size_t y, int direction) const;
+    // Returns the number of rows of the window, rows[k] is the one holding the cells k - s_Margin rows away from the first of the tile
+    size_t gatherWindow(const Neighborhood& neighborhood, CellState* window, size_t* rows, bool* ghostRows) const;
+    void stepTile(const Neighborhood& neighborhood);
+    void countTile(size_t tile, const CellState* cells);
+
+    // Runs function(tile, cells, bounds) on every tile of the current generation, paging them in one after the other
+    template<typename Function>
+    void forEachTile(Function function)
+    {
+        for (size_t tile = 0; tile < m_Store.getNumberOfTiles(); tile++)
+        {
+            function(tile, m_Store.acquire(m_Front, tile), m_Activity.getTileBounds(tile));
+            m_Store.trim();
+        }
+    }
+
+public:
+    // An empty path keeps the grid in a temporary file
+    MappedBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border, const std::string& path,
+        size_t residentBytes, bool profiling = false);
+
+    bool isAvailable() const { return m_Store.isOpen(); }
+    std::string getName() const override { return "Mapped (" + std::to_string(m_Pool.getNumberOfThreads()) + " threads)"; }
+
+    void inject(const std::vector<Injection>& injections) override;
+    void step() override;
+    void count(uint64_t counts[3]) override;
+
+    // The whole grid is copied to memory, it is only meant for grids small enough to draw
+    const CellState* getStates() override;
+    void exportStates(CellState* states) override;
+    void importStates(const CellState* states) override;
+    void setActivityTracking(bool enabled) override { m_Activity.setEnabled(enabled); }
+    // Imports whole rows of the current generation, grids larger than memory are seeded a band of rows at a time
+    void importRows(size_t firstRow, size_t numberOfRows, const CellState* states);
+
+    StageProfiler* getProfiler() override { return &m_Profiler; }
+};
\ No newline at end of file
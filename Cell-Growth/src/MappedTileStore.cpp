@@ -0,0 +1,153 @@
+#include "MappedTileStore.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "SimulationLog.h"
+
+constexpr size_t MappedTileStore::TileSize;
+constexpr size_t MappedTileStore::TileBytes;
+
+namespace {
+
+std::string getTemporaryPath()
+{
+#ifdef _WIN32
+    char directory[MAX_PATH + 1];
+    DWORD length = GetTempPathA(sizeof(directory), directory);
+    std::string path = length > 0 && length < sizeof(directory) ? std::string(directory, length) : std::string(".\\");
+    return path + "cell-growth-" + std::to_string(GetCurrentProcessId()) + ".grid";
+#else
+    const char* directory = std::getenv("TMPDIR");
+    return std::string(directory ? directory : "/tmp") + "/cell-growth-" + std::to_string(getpid()) + ".grid";
+#endif
+}
+
+}
+
+MappedTileStore::MappedTileStore(size_t numberOfCellInX, size_t numberOfCellInY, const std::string& path, size_t residentBytes) :
+    m_NumberOfTileX((numberOfCellInX + TileSize - 1) / TileSize),
+    m_NumberOfTileY((numberOfCellInY + TileSize - 1) / TileSize),
+    // Stepping a row of tiles reads the rows around it and writes the other generation
+    m_MaxResidentTiles(std::max(residentBytes / TileBytes, 4 * m_NumberOfTileX + 4))
+{
+    bool temporary = path.empty();
+    std::string filePath = temporary ? getTemporaryPath() : path;
+    uint64_t size = (uint64_t)2 * getNumberOfTiles() * TileBytes;
+
+#ifdef _WIN32
+    DWORD flags = temporary ? FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE : FILE_ATTRIBUTE_NORMAL;
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, flags, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        SIM_ERROR("Cannot create grid file: {0}", filePath);
+        return;
+    }
+    m_File = file;
+
+    // The mapping extends the file to its size
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, NULL);
+    if (!mapping)
+    {
+        SIM_ERROR("Cannot map grid file: {0}", filePath);
+        return;
+    }
+    m_Mapping = mapping;
+#else
+    m_File = open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_File < 0)
+    {
+        SIM_ERROR("Cannot create grid file: {0}", filePath);
+        return;
+    }
+    if (temporary)
+        unlink(filePath.c_str());
+    if (ftruncate(m_File, (off_t)size) != 0)
+    {
+        SIM_ERROR("Cannot resize grid file: {0}", filePath);
+        return;
+    }
+#endif
+
+    m_Open = true;
+    SIM_INFO("Grid file: {0} ({1} MiB, {2} MiB resident)", temporary ? "temporary" : filePath, size >> 20, (m_MaxResidentTiles * TileBytes) >> 20);
+}
+
+MappedTileStore::~MappedTileStore()
+{
+    for (auto& view : m_Views)
+        unmapView(view.second.Cells);
+
+#ifdef _WIN32
+    if (m_Mapping)
+        CloseHandle((HANDLE)m_Mapping);
+    if (m_File)
+        CloseHandle((HANDLE)m_File);
+#else
+    if (m_File >= 0)
+        close(m_File);
+#endif
+}
+
+CellState* MappedTileStore::mapView(size_t key)
+{
+    uint64_t offset = (uint64_t)key * TileBytes;
+#ifdef _WIN32
+    void* cells = MapViewOfFile((HANDLE)m_Mapping, FILE_MAP_ALL_ACCESS, (DWORD)(offset >> 32), (DWORD)offset, TileBytes);
+#else
+    void* cells = mmap(NULL, TileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_File, (off_t)offset);
+    if (cells == MAP_FAILED)
+        cells = nullptr;
+#endif
+    if (!cells)
+    {
+        SIM_ERROR("Cannot map grid tile {0}", key);
+        std::abort();
+    }
+    return (CellState*)cells;
+}
+
+void MappedTileStore::unmapView(CellState* cells)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(cells);
+#else
+    munmap(cells, TileBytes);
+#endif
+}
+
+CellState* MappedTileStore::acquire(size_t generation, size_t tile)
+{
+    size_t key = generation * getNumberOfTiles() + tile;
+    auto it = m_Views.find(key);
+    if (it != m_Views.end())
+    {
+        m_Uses.splice(m_Uses.begin(), m_Uses, it->second.Use);
+        return it->second.Cells;
+    }
+
+    m_Uses.push_front(key);
+    View view = { mapView(key), m_Uses.begin() };
+    m_Views.emplace(key, view);
+    return view.Cells;
+}
+
+void MappedTileStore::trim()
+{
+    while (m_Views.size() > m_MaxResidentTiles)
+    {
+        auto it = m_Views.find(m_Uses.back());
+        unmapView(it->second.Cells);
+        m_Views.erase(it);
+        m_Uses.pop_back();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "CellState.h"
+
+// Two generations of the grid in a memory-mapped file, stored as square tiles of contiguous cells
+// Tiles are mapped when they are first acquired and unmapped, least recently used first, once the resident set exceeds its budget
+class MappedTileStore
+{
+public:
+    // 64 KiB per tile, a multiple of the mapping granularity of every platform
+    static constexpr size_t TileSize = 256;
+    static constexpr size_t TileBytes = TileSize * TileSize * sizeof(CellState);
+
+private:
+    struct View
+    {
+        CellState* Cells;
+        std::list<size_t>::iterator Use;
+    };
+
+    const size_t m_NumberOfTileX;
+    const size_t m_NumberOfTileY;
+    const size_t m_MaxResidentTiles;
+
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#else
+    int m_File = -1;
+#endif
+    bool m_Open = false;
+
+    // Keyed by generation and tile, the front of the list is the most recently used view
+    std::unordered_map<size_t, View> m_Views;
+    std::list<size_t> m_Uses;
+
+private:
+    CellState* mapView(size_t key);
+    void unmapView(CellState* cells);
+
+public:
+    // An empty path creates a temporary file that is deleted once closed
+    MappedTileStore(size_t numberOfCellInX, size_t numberOfCellInY, const std::string& path, size_t residentBytes);
+    ~MappedTileStore();
+
+    MappedTileStore(const MappedTileStore&) = delete;
+    MappedTileStore& operator=(const MappedTileStore&) = delete;
+
+    bool isOpen() const { return m_Open; }
+    size_t getNumberOfTileX() const { return m_NumberOfTileX; }
+    size_t getNumberOfTileY() const { return m_NumberOfTileY; }
+    size_t getNumberOfTiles() const { return m_NumberOfTileX * m_NumberOfTileY; }
+    size_t getNumberOfResidentTiles() const { return m_Views.size(); }
+
+    // The cells stay mapped at least until the next call to trim, rows of the tile are TileSize cells apart
+    CellState* acquire(size_t generation, size_t tile);
+    // Unmaps the least recently used tiles above the budget, no pointer acquired before may be used afterwards
+    void trim();
+};
\ No newline at end of file
@@ -0,0 +1,523 @@
+#include "OpenCLBackend.h"
+
+#include <algorithm>
+#include <cstring>
+
+constexpr size_t OpenCLBackend::s_ActivityTileSize;
+
+OpenCLBackend::OpenCLBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border, const std::string& device,
+    bool profiling) :
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCellY(numberOfCellInY),
+    m_NumberOfCell(numberOfCellInX * numberOfCellInY),
+    m_RowsPerPartition(std::max(rowsPerPartition, (size_t)1)),
+    m_Layout(numberOfCellInX, numberOfCellInY, m_RowsPerPartition)
+{
+    int ret = 0;
+    m_Available = m_CLWrapper.Init("res/cl/cell_kernel.cl", device, true, profiling);
+    if (!m_Available)
+        return;
+    m_Profiler.setEnabled(m_CLWrapper.Profiling);
+
+    // The grid, its partitions and the rules are compile-time constants of the program
+    std::string options = "-D NUMBER_OF_CELL_X=" + std::to_string(m_NumberOfCellX)
+        + " -D NUMBER_OF_CELL_Y=" + std::to_string(m_NumberOfCellY)
+        + " -D ROWS_PER_PARTITION=" + std::to_string(m_RowsPerPartition)
+        + " -D BORDER_CELL=" + std::to_string(getBorderCell(border))
+        + " -D ACTIVITY_TILE_SIZE=" + std::to_string(s_ActivityTileSize)
+        + " -D CANCER_THRESHOLD=" + std::to_string(CancerThreshold)
+        + " -D CURE_THRESHOLD=" + std::to_string(CureThreshold);
+    m_Program = m_CLWrapper.getProgram(options);
+
+    // Allocate the simulation state once, it lives on the device for the lifetime of the backend
+    // The ghosts are uploaded with the buffers, the kernels never write them, the resolved cells use the same values
+    m_ZeroCopy = m_CLWrapper.HostUnifiedMemory;
+    AlignedArray<CellState> ghosts(m_Layout.NumberOfCell);
+    m_Layout.fillGhosts(ghosts.data(), getBorderCell(border), VoidCell);
+    cl_mem_flags viewFlags = CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR | (m_ZeroCopy ? CL_MEM_ALLOC_HOST_PTR : 0);
+    for (size_t i = 0; i < 2; i++)
+    {
+        m_StateBuffers[i] = clCreateBuffer(m_CLWrapper.Context, viewFlags, m_Layout.NumberOfCell * sizeof(CellState), ghosts.data(), &ret);
+        CL_ASSERT(ret);
+    }
+    m_ResolvedCellsBuffer = clCreateBuffer(m_CLWrapper.Context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+        m_Layout.NumberOfCell * sizeof(cl_uchar), ghosts.data(), &ret);
+    CL_ASSERT(ret);
+
+    // Every tile starts as changed, the first generation steps the whole grid
+    m_ActivityGlobalSize[0] = (m_Layout.Stride + s_ActivityTileSize - 1) / s_ActivityTileSize;
+    m_ActivityGlobalSize[1] = (m_Layout.NumberOfRows + s_ActivityTileSize - 1) / s_ActivityTileSize;
+    std::vector<cl_uchar> changedTiles(m_ActivityGlobalSize[0] * m_ActivityGlobalSize[1], 1);
+    m_ActiveTilesBuffer = clCreateBuffer(m_CLWrapper.Context, CL_MEM_READ_WRITE, changedTiles.size(), NULL, &ret);
+    CL_ASSERT(ret);
+    for (size_t i = 0; i < 2; i++)
+    {
+        m_ChangedTilesBuffers[i] = clCreateBuffer(m_CLWrapper.Context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+            changedTiles.size(), changedTiles.data(), &ret);
+        CL_ASSERT(ret);
+    }
+
+    m_CountBuffer = clCreateBuffer(m_CLWrapper.Context, CL_MEM_READ_WRITE, sizeof(m_CellCounts), NULL, &ret);
+    CL_ASSERT(ret);
+
+    // The first generation is imported, the drawn view only has to exist until then
+    m_ViewStates.allocate(m_NumberOfCell);
+    if (m_ZeroCopy)
+    {
+        mapBuffers(m_Front, CL_MAP_READ, CL_TRUE, {}, nullptr);
+        m_DrawnStates = m_MappedStates[m_Front];
+    }
+    else
+    {
+        for (size_t i = 0; i < 2; i++)
+        {
+            m_HostStates[i].allocate(m_Layout.NumberOfCell);
+            memcpy(m_HostStates[i].data(), ghosts.data(), m_Layout.NumberOfCell * sizeof(CellState));
+        }
+        m_DrawnStates = m_HostStates[m_HostFront].data();
+    }
+
+    bindKernels();
+}
+
+OpenCLBackend::~OpenCLBackend()
+{
+    if (!m_Available)
+    {
+        m_CLWrapper.Shutdown();
+        return;
+    }
+
+    // Pending readbacks target host memory owned by this object
+    CL_ASSERT(clFinish(m_CLWrapper.CommandQueue));
+    for (size_t i = 0; i < 2; i++)
+        unmapBuffers(i);
+    CL_ASSERT(clFinish(m_CLWrapper.CommandQueue));
+
+    for (cl_event event : m_UploadEvents)
+        CL_ASSERT(clReleaseEvent(event));
+    for (cl_event event : m_ReadbackEvents)
+    {
+        if (event)
+            CL_ASSERT(clReleaseEvent(event));
+    }
+    if (m_AdvanceEvent)
+        CL_ASSERT(clReleaseEvent(m_AdvanceEvent));
+    if (m_InjectionUploadEvent)
+        CL_ASSERT(clReleaseEvent(m_InjectionUploadEvent));
+    m_Profiler.clear();
+
+    for (size_t i = 0; i < 2; i++)
+        CL_ASSERT(clReleaseMemObject(m_StateBuffers[i]));
+    CL_ASSERT(clReleaseMemObject(m_ResolvedCellsBuffer));
+    CL_ASSERT(clReleaseMemObject(m_ActiveTilesBuffer));
+    for (size_t i = 0; i < 2; i++)
+        CL_ASSERT(clReleaseMemObject(m_ChangedTilesBuffers[i]));
+    CL_ASSERT(clReleaseMemObject(m_CountBuffer));
+    if (m_InjectionBuffer)
+        CL_ASSERT(clReleaseMemObject(m_InjectionBuffer));
+
+    m_CLWrapper.Shutdown();
+}
+
+void OpenCLBackend::finish()
+{
+    if (!m_ReadbackEvents[0])
+        return;
+
+    // The generation enqueued on the previous update becomes the one drawn and counted
+    CL_ASSERT(clWaitForEvents(2, m_ReadbackEvents));
+    for (cl_event& event : m_ReadbackEvents)
+    {
+        CL_ASSERT(clReleaseEvent(event));
+        event = nullptr;
+    }
+    m_Profiler.collect();
+    if (m_ZeroCopy)
+    {
+        m_DrawnStates = m_MappedStates[m_Front];
+    }
+    else
+    {
+        m_HostFront ^= 1;
+        m_DrawnStates = m_HostStates[m_HostFront].data();
+    }
+    m_ViewDirty = true;
+}
+
+void OpenCLBackend::mapBuffers(size_t buffer, cl_map_flags flags, cl_bool blocking, const std::vector<cl_event>& waitList, cl_event* event)
+{
+    int ret = 0;
+    m_MappedStates[buffer] = (CellState*)clEnqueueMapBuffer(m_CLWrapper.CommandQueue, m_StateBuffers[buffer], blocking, flags,
+        0, m_Layout.NumberOfCell * sizeof(CellState), (cl_uint)waitList.size(), waitList.empty() ? NULL : waitList.data(), event, &ret);
+    CL_ASSERT(ret);
+}
+
+void OpenCLBackend::unmapBuffers(size_t buffer)
+{
+    if (!m_MappedStates[buffer])
+        return;
+
+    // Everything writing the buffer afterwards waits on the unmap through the upload events
+    cl_event event;
+    CL_ASSERT(clEnqueueUnmapMemObject(m_CLWrapper.CommandQueue, m_StateBuffers[buffer], m_MappedStates[buffer], 0, NULL, &event));
+    m_Profiler.track("Unmap States", event, 0);
+    m_UploadEvents.push_back(event);
+    m_MappedStates[buffer] = nullptr;
+}
+
+void OpenCLBackend::bindKernels()
+{
+    int numberOfCellInX = (int)m_NumberOfCellX;
+    int numberOfCellInY = (int)m_NumberOfCellY;
+    int rowsPerPartition = (int)m_RowsPerPartition;
+
+    // Square tiles of 16 cells, or 8 when the device cannot run work-groups that large
+    if (m_TiledKernels)
+    {
+        size_t maxLocalSize = 256;
+        for (const char* name : { "resolve_cells_tiled", "advance_cells_tiled" })
+        {
+            size_t kernelLocalSize = 1;
+            CL_ASSERT(clGetKernelWorkGroupInfo(m_CLWrapper.getKernel(m_Program, name), m_CLWrapper.getDevice(),
+                CL_KERNEL_WORK_GROUP_SIZE, sizeof(kernelLocalSize), &kernelLocalSize, NULL));
+            maxLocalSize = std::min(maxLocalSize, kernelLocalSize);
+        }
+        size_t tileSize = maxLocalSize >= 256 ? 16 : (maxLocalSize >= 64 ? 8 : 0);
+        if (tileSize == 0)
+        {
+            SIM_WARN("Work-groups are too small for the tiled kernels, using the direct kernels");
+            m_TiledKernels = false;
+        }
+        else
+        {
+            m_GenerationDimensions = 2;
+            m_GenerationLocalSize[0] = tileSize;
+            m_GenerationLocalSize[1] = tileSize;
+            m_GenerationGlobalSize[0] = (m_Layout.Stride + tileSize - 1) / tileSize * tileSize;
+            m_GenerationGlobalSize[1] = (m_Layout.NumberOfRows + tileSize - 1) / tileSize * tileSize;
+        }
+    }
+    if (!m_TiledKernels)
+    {
+        m_GenerationDimensions = 1;
+        m_GenerationGlobalSize[0] = m_Layout.NumberOfCell;
+        m_GenerationGlobalSize[1] = 1;
+    }
+
+    // Work-items span the padded grid, the ghosts only load the tiles and return
+    // A source across a seam is two rows away, the states need a halo of two cells and the resolved cells around it one more
+    size_t resolveTileSize = (m_GenerationLocalSize[0] + 2) * (m_GenerationLocalSize[1] + 2);
+    size_t stateTileSize = (m_GenerationLocalSize[0] + 4) * (m_GenerationLocalSize[1] + 4);
+    size_t resolvedTileSize = (m_GenerationLocalSize[0] + 6) * (m_GenerationLocalSize[1] + 6);
+
+    for (unsigned int variant = 0; variant < 2; variant++)
+    {
+        GenerationKernels& kernels = m_GenerationKernels[variant];
+        size_t front = variant;
+
+        // The generation reads the changes of the previous one and clears the flags it writes itself
+        kernels.Activate = m_CLWrapper.getKernel(m_Program, "activate_tiles", variant);
+        CL_ASSERT(clSetKernelArg(kernels.Activate, 0, sizeof(int), (void*)&numberOfCellInX));
+        CL_ASSERT(clSetKernelArg(kernels.Activate, 1, sizeof(int), (void*)&numberOfCellInY));
+        CL_ASSERT(clSetKernelArg(kernels.Activate, 2, sizeof(int), (void*)&rowsPerPartition));
+        CL_ASSERT(clSetKernelArg(kernels.Activate, 3, sizeof(cl_mem), (void*)&m_ChangedTilesBuffers[front]));
+        CL_ASSERT(clSetKernelArg(kernels.Activate, 4, sizeof(cl_mem), (void*)&m_ActiveTilesBuffer));
+        CL_ASSERT(clSetKernelArg(kernels.Activate, 5, sizeof(cl_mem), (void*)&m_ChangedTilesBuffers[front ^ 1]));
+
+        // Both variants take the same arguments, the tiled ones also get their local tiles
+        kernels.Resolve = m_CLWrapper.getKernel(m_Program, m_TiledKernels ? "resolve_cells_tiled" : "resolve_cells", variant);
+        CL_ASSERT(clSetKernelArg(kernels.Resolve, 0, sizeof(int), (void*)&numberOfCellInX));
+        CL_ASSERT(clSetKernelArg(kernels.Resolve, 1, sizeof(int), (void*)&numberOfCellInY));
+        CL_ASSERT(clSetKernelArg(kernels.Resolve, 2, sizeof(int), (void*)&rowsPerPartition));
+        CL_ASSERT(clSetKernelArg(kernels.Resolve, 3, sizeof(cl_mem), (void*)&m_StateBuffers[front]));
+        CL_ASSERT(clSetKernelArg(kernels.Resolve, 4, sizeof(cl_mem), (void*)&m_ActiveTilesBuffer));
+        CL_ASSERT(clSetKernelArg(kernels.Resolve, 5, sizeof(cl_mem), (void*)&m_ResolvedCellsBuffer));
+
+        kernels.Advance = m_CLWrapper.getKernel(m_Program, m_TiledKernels ? "advance_cells_tiled" : "advance_cells", variant);
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 0, sizeof(int), (void*)&numberOfCellInX));
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 1, sizeof(int), (void*)&numberOfCellInY));
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 2, sizeof(int), (void*)&rowsPerPartition));
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 3, sizeof(cl_mem), (void*)&m_StateBuffers[front]));
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 4, sizeof(cl_mem), (void*)&m_ResolvedCellsBuffer));
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 5, sizeof(cl_mem), (void*)&m_ActiveTilesBuffer));
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 6, sizeof(cl_mem), (void*)&m_StateBuffers[front ^ 1]));
+        CL_ASSERT(clSetKernelArg(kernels.Advance, 7, sizeof(cl_mem), (void*)&m_ChangedTilesBuffers[front ^ 1]));
+
+        if (m_TiledKernels)
+        {
+            CL_ASSERT(clSetKernelArg(kernels.Resolve, 6, resolveTileSize, NULL));
+            CL_ASSERT(clSetKernelArg(kernels.Advance, 8, stateTileSize, NULL));
+            CL_ASSERT(clSetKernelArg(kernels.Advance, 9, resolvedTileSize, NULL));
+        }
+
+        // Counting runs on the generation the advance pass just wrote
+        kernels.Count = m_CLWrapper.getKernel(m_Program, "count_cells", variant);
+        CL_ASSERT(clSetKernelArg(kernels.Count, 0, sizeof(int), (void*)&numberOfCellInX));
+        CL_ASSERT(clSetKernelArg(kernels.Count, 1, sizeof(int), (void*)&numberOfCellInY));
+        CL_ASSERT(clSetKernelArg(kernels.Count, 2, sizeof(int), (void*)&rowsPerPartition));
+        CL_ASSERT(clSetKernelArg(kernels.Count, 3, sizeof(cl_mem), (void*)&m_StateBuffers[front ^ 1]));
+        CL_ASSERT(clSetKernelArg(kernels.Count, 4, sizeof(cl_mem), (void*)&m_CountBuffer));
+
+        // Injections write the generation about to be read and mark its tiles as changed for the activation
+        kernels.Inject = m_CLWrapper.getKernel(m_Program, "inject_medecine", variant);
+        CL_ASSERT(clSetKernelArg(kernels.Inject, 0, sizeof(int), (void*)&numberOfCellInX));
+        CL_ASSERT(clSetKernelArg(kernels.Inject, 1, sizeof(int), (void*)&numberOfCellInY));
+        CL_ASSERT(clSetKernelArg(kernels.Inject, 2, sizeof(int), (void*)&rowsPerPartition));
+        CL_ASSERT(clSetKernelArg(kernels.Inject, 4, sizeof(cl_mem), (void*)&m_InjectionBuffer));
+        CL_ASSERT(clSetKernelArg(kernels.Inject, 5, sizeof(cl_mem), (void*)&m_StateBuffers[front]));
+        CL_ASSERT(clSetKernelArg(kernels.Inject, 6, sizeof(cl_mem), (void*)&m_ChangedTilesBuffers[front]));
+    }
+
+    // Largest power of two work-group the device allows, with enough groups to fill every compute unit
+    size_t maxLocalSize = 1;
+    cl_uint computeUnits = 1;
+    CL_ASSERT(clGetKernelWorkGroupInfo(m_GenerationKernels[0].Count, m_CLWrapper.getDevice(), CL_KERNEL_WORK_GROUP_SIZE,
+        sizeof(maxLocalSize), &maxLocalSize, NULL));
+    CL_ASSERT(clGetDeviceInfo(m_CLWrapper.getDevice(), CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(computeUnits), &computeUnits, NULL));
+    m_CountLocalSize = 1;
+    while (m_CountLocalSize * 2 <= std::min(maxLocalSize, (size_t)256))
+        m_CountLocalSize *= 2;
+    size_t numberOfGroups = std::min((m_NumberOfCell + m_CountLocalSize - 1) / m_CountLocalSize, (size_t)computeUnits * 8);
+    m_CountGlobalSize = numberOfGroups * m_CountLocalSize;
+    for (const GenerationKernels& kernels : m_GenerationKernels)
+        CL_ASSERT(clSetKernelArg(kernels.Count, 5, 3 * m_CountLocalSize * sizeof(cl_uint), NULL));
+}
+
+void OpenCLBackend::step()
+{
+    // A generation is two passes, the cured cancer cells have to be known before the medecine around them can move
+    // A generation stepped without being finished is retired first, its readback still uses the buffers this one writes
+    finish();
+
+    const GenerationKernels& kernels = m_GenerationKernels[m_Front];
+    const size_t back = m_Front ^ 1;
+
+    // The previous generation was mapped while it was drawn, it is about to be overwritten, as the drawn one is by injections
+    if (m_ZeroCopy)
+    {
+        unmapBuffers(back);
+        if (!m_PendingInjections.empty())
+            unmapBuffers(m_Front);
+    }
+
+    std::vector<cl_event> waitList = m_UploadEvents;
+    if (m_AdvanceEvent)
+        waitList.push_back(m_AdvanceEvent);
+    if (!m_PendingInjections.empty())
+        injectCells(kernels, waitList);
+    if (!m_ActivityTracking)
+    {
+        cl_uchar changed = 1;
+        cl_event fillEvent;
+        CL_ASSERT(clEnqueueFillBuffer(m_CLWrapper.CommandQueue, m_ChangedTilesBuffers[m_Front], &changed, sizeof(changed),
+            0, m_ActivityGlobalSize[0] * m_ActivityGlobalSize[1], (cl_uint)waitList.size(), waitList.empty() ? NULL : waitList.data(), &fillEvent));
+        waitList.push_back(fillEvent);
+    }
+
+    cl_event activateEvent;
+    CL_ASSERT(clEnqueueNDRangeKernel(m_CLWrapper.CommandQueue, kernels.Activate, 2, NULL,
+        m_ActivityGlobalSize, NULL, (cl_uint)waitList.size(), waitList.empty() ? NULL : waitList.data(), &activateEvent));
+    m_Profiler.track("Activate", activateEvent, 3 * m_ActivityGlobalSize[0] * m_ActivityGlobalSize[1]);
+
+    // Work-groups and work-items of tiles that are not active return at once
+    cl_event resolveEvent;
+    const size_t* localSize = m_TiledKernels ? m_GenerationLocalSize : nullptr;
+    CL_ASSERT(clEnqueueNDRangeKernel(m_CLWrapper.CommandQueue, kernels.Resolve, m_GenerationDimensions, NULL,
+        m_GenerationGlobalSize, localSize, 1, &activateEvent, &resolveEvent));
+    CL_ASSERT(clReleaseEvent(activateEvent));
+    m_Profiler.track("Resolve", resolveEvent, 2 * m_NumberOfCell * sizeof(CellState));
+
+    // Kernels may read a buffer mapped for reading, the drawn generation is mapped again if injecting unmapped it
+    if (m_ZeroCopy && !m_MappedStates[m_Front])
+    {
+        mapBuffers(m_Front, CL_MAP_READ, CL_TRUE, waitList, nullptr);
+        m_DrawnStates = m_MappedStates[m_Front];
+        m_ViewDirty = true;
+    }
+
+    for (cl_event event : waitList)
+        CL_ASSERT(clReleaseEvent(event));
+    m_UploadEvents.clear();
+
+    CL_ASSERT(clEnqueueNDRangeKernel(m_CLWrapper.CommandQueue, kernels.Advance, m_GenerationDimensions, NULL,
+        m_GenerationGlobalSize, localSize, 1, &resolveEvent, &m_AdvanceEvent));
+    m_Profiler.track("Advance", m_AdvanceEvent, 3 * m_NumberOfCell * sizeof(CellState));
+    CL_ASSERT(clReleaseEvent(resolveEvent));
+    m_Front ^= 1;
+
+    // Read back into the host copy that is not being drawn, finishGeneration waits on it next update
+    if (m_ZeroCopy)
+    {
+        mapBuffers(m_Front, CL_MAP_READ, CL_FALSE, { m_AdvanceEvent }, &m_ReadbackEvents[0]);
+        m_Profiler.track("Map States", m_ReadbackEvents[0], 0);
+    }
+    else
+    {
+        const size_t hostBack = m_HostFront ^ 1;
+        CL_ASSERT(clEnqueueReadBuffer(m_CLWrapper.CommandQueue, m_StateBuffers[m_Front], CL_FALSE, 0,
+            m_Layout.NumberOfCell * sizeof(CellState), m_HostStates[hostBack].data(), 1, &m_AdvanceEvent, &m_ReadbackEvents[0]));
+        m_Profiler.track("Read States", m_ReadbackEvents[0], m_Layout.NumberOfCell * sizeof(CellState));
+    }
+    countCells(kernels);
+    CL_ASSERT(clFlush(m_CLWrapper.CommandQueue));
+}
+
+void OpenCLBackend::injectCells(const GenerationKernels& kernels, std::vector<cl_event>& waitList)
+{
+    // The records of the previous injection may still be uploading from the host
+    if (m_InjectionUploadEvent)
+    {
+        CL_ASSERT(clWaitForEvents(1, &m_InjectionUploadEvent));
+        CL_ASSERT(clReleaseEvent(m_InjectionUploadEvent));
+        m_InjectionUploadEvent = nullptr;
+    }
+    m_UploadedInjections.swap(m_PendingInjections);
+    m_PendingInjections.clear();
+
+    // A released buffer lives until the commands using it completed
+    int ret = 0;
+    size_t numberOfRecords = m_UploadedInjections.size();
+    if (numberOfRecords > m_InjectionCapacity)
+    {
+        if (m_InjectionBuffer)
+            CL_ASSERT(clReleaseMemObject(m_InjectionBuffer));
+        m_InjectionCapacity = std::max(numberOfRecords, 2 * m_InjectionCapacity);
+        m_InjectionBuffer = clCreateBuffer(m_CLWrapper.Context, CL_MEM_READ_ONLY, m_InjectionCapacity * sizeof(cl_int4), NULL, &ret);
+        CL_ASSERT(ret);
+        for (const GenerationKernels& variant : m_GenerationKernels)
+            CL_ASSERT(clSetKernelArg(variant.Inject, 4, sizeof(cl_mem), (void*)&m_InjectionBuffer));
+    }
+
+    CL_ASSERT(clEnqueueWriteBuffer(m_CLWrapper.CommandQueue, m_InjectionBuffer, CL_FALSE, 0, numberOfRecords * sizeof(cl_int4),
+        m_UploadedInjections.data(), 0, NULL, &m_InjectionUploadEvent));
+    m_Profiler.track("Write Injections", m_InjectionUploadEvent, numberOfRecords * sizeof(cl_int4));
+
+    std::vector<cl_event> injectWaitList = waitList;
+    injectWaitList.push_back(m_InjectionUploadEvent);
+    int recordCount = (int)numberOfRecords;
+    cl_event injectEvent;
+    CL_ASSERT(clSetKernelArg(kernels.Inject, 3, sizeof(int), (void*)&recordCount));
+    CL_ASSERT(clEnqueueNDRangeKernel(m_CLWrapper.CommandQueue, kernels.Inject, 1, NULL, &numberOfRecords, NULL,
+        (cl_uint)injectWaitList.size(), injectWaitList.data(), &injectEvent));
+    m_Profiler.track("Inject", injectEvent, numberOfRecords * 8 * sizeof(CellState));
+    waitList.push_back(injectEvent);
+}
+
+void OpenCLBackend::countCells(const GenerationKernels& kernels)
+{
+    // Only the three counters leave the device, the previous ones were read back before this generation was enqueued
+    int zero = 0;
+    cl_event fillEvent;
+    cl_event countEvent;
+    CL_ASSERT(clEnqueueFillBuffer(m_CLWrapper.CommandQueue, m_CountBuffer, &zero, sizeof(int),
+        0, sizeof(m_CellCounts), 0, NULL, &fillEvent));
+
+    cl_event waitList[2] = { m_AdvanceEvent, fillEvent };
+    CL_ASSERT(clEnqueueNDRangeKernel(m_CLWrapper.CommandQueue, kernels.Count, 1, NULL,
+        &m_CountGlobalSize, &m_CountLocalSize, 2, waitList, &countEvent));
+    CL_ASSERT(clEnqueueReadBuffer(m_CLWrapper.CommandQueue, m_CountBuffer, CL_FALSE, 0,
+        sizeof(m_CellCounts), m_CellCounts, 1, &countEvent, &m_ReadbackEvents[1]));
+
+    m_Profiler.track("Clear Counts", fillEvent, sizeof(m_CellCounts));
+    m_Profiler.track("Count", countEvent, m_NumberOfCell * sizeof(CellState));
+    m_Profiler.track("Read Counts", m_ReadbackEvents[1], sizeof(m_CellCounts));
+
+    CL_ASSERT(clReleaseEvent(fillEvent));
+    CL_ASSERT(clReleaseEvent(countEvent));
+}
+
+void OpenCLBackend::setTiledKernels(bool tiledKernels)
+{
+    // Arguments are captured when a kernel is enqueued, the generation in flight is not affected
+    if (tiledKernels == m_TiledKernels)
+        return;
+    m_TiledKernels = tiledKernels;
+    bindKernels();
+}
+
+void OpenCLBackend::inject(const std::vector<Injection>& injections)
+{
+    // Nothing is read or written on the host, the generation may stay on the device
+    for (const Injection& injection : injections)
+    {
+        cl_int4 record;
+        record.s[0] = (cl_int)injection.Index;
+        record.s[1] = injection.NumberOfCells;
+        record.s[2] = (cl_int)injection.Seed;
+        record.s[3] = 0;
+        m_PendingInjections.push_back(record);
+    }
+}
+
+void OpenCLBackend::count(uint64_t counts[3])
+{
+    for (size_t type = 0; type < 3; type++)
+        counts[type] = (uint64_t)m_CellCounts[3 + type] << 32 | m_CellCounts[type];
+}
+
+const CellState* OpenCLBackend::getStates()
+{
+    if (m_ViewDirty)
+    {
+        m_Layout.unpack(m_DrawnStates, m_ViewStates.data());
+        m_ViewDirty = false;
+    }
+    return m_ViewStates.data();
+}
+
+void OpenCLBackend::exportStates(CellState* states)
+{
+    m_Layout.unpack(m_DrawnStates, states);
+}
+
+void OpenCLBackend::importStates(const CellState* states)
+{
+    // The generation in flight completes first, the imported one replaces it with the injections meant for it
+    finish();
+    m_PendingInjections.clear();
+    // Only the cells are written, the ghosts of the buffer are kept
+    if (m_ZeroCopy)
+    {
+        unmapBuffers(m_Front);
+        mapBuffers(m_Front, CL_MAP_WRITE, CL_TRUE, m_UploadEvents, nullptr);
+        for (cl_event event : m_UploadEvents)
+            CL_ASSERT(clReleaseEvent(event));
+        m_UploadEvents.clear();
+        m_Layout.pack(states, m_MappedStates[m_Front]);
+        unmapBuffers(m_Front);
+    }
+    else
+    {
+        m_Layout.pack(states, m_DrawnStates);
+        CL_ASSERT(clEnqueueWriteBuffer(m_CLWrapper.CommandQueue, m_StateBuffers[m_Front], CL_TRUE, 0, m_Layout.NumberOfCell * sizeof(CellState),
+            m_DrawnStates, (cl_uint)m_UploadEvents.size(), m_UploadEvents.empty() ? NULL : m_UploadEvents.data(), NULL));
+        for (cl_event event : m_UploadEvents)
+            CL_ASSERT(clReleaseEvent(event));
+        m_UploadEvents.clear();
+    }
+
+    // Every tile of the imported generation has changed, the next generation waits on the fill with the uploads
+    cl_uchar changed = 1;
+    cl_event fillEvent;
+    CL_ASSERT(clEnqueueFillBuffer(m_CLWrapper.CommandQueue, m_ChangedTilesBuffers[m_Front], &changed, sizeof(changed),
+        0, m_ActivityGlobalSize[0] * m_ActivityGlobalSize[1], 0, NULL, &fillEvent));
+    m_UploadEvents.push_back(fillEvent);
+
+    if (m_ZeroCopy)
+    {
+        mapBuffers(m_Front, CL_MAP_READ, CL_TRUE, m_UploadEvents, nullptr);
+        m_DrawnStates = m_MappedStates[m_Front];
+    }
+    m_ViewDirty = true;
+
+    // Counted on the host, the count kernel only runs with a generation
+    uint64_t counts[3] = { 0, 0, 0 };
+    for (size_t i = 0; i < m_NumberOfCell; i++)
+        counts[states[i] & CellTypeMask]++;
+    for (size_t type = 0; type < 3; type++)
+    {
+        m_CellCounts[type] = (cl_uint)counts[type];
+        m_CellCounts[3 + type] = (cl_uint)(counts[type] >> 32);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "AlignedArray.h"
+#include "EventProfiler.h"
+#include "OpenCLWrapper.h"
+#include "SimulationBackend.h"
+
+// Keeps the simulation resident on an OpenCL device, a generation is enqueued by step and read back until finish or the next step
+class OpenCLBackend : public SimulationBackend
+{
+private:
+    OpenCLWrapper m_CLWrapper;
+    EventProfiler m_Profiler;
+    bool m_Available = false;
+
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCellY;
+    const size_t m_NumberOfCell;
+    const size_t m_RowsPerPartition;
+    // The device buffers hold the grid with its ghosts, every cell reads its neighbors at the same offsets
+    const GhostLayout m_Layout;
+
+    // The host keeps the generation being drawn while the next one is computed and read back into the other copy
+    size_t m_HostFront = 0;
+    AlignedArray<CellState> m_HostStates[2];
+
+    // Generation being drawn with its ghosts, a host copy or a mapping of the device buffer when memory is shared
+    bool m_ZeroCopy = false;
+    CellState* m_DrawnStates = nullptr;
+    CellState* m_MappedStates[2] = { nullptr, nullptr };
+    // Drawn generation without its ghosts, only unpacked when asked for
+    AlignedArray<CellState> m_ViewStates;
+    bool m_ViewDirty = true;
+
+    cl_program m_Program = nullptr;
+
+    // Simulation state stays resident on the device, each pass reads the front buffer and writes the back one
+    size_t m_Front = 0;
+    cl_mem m_StateBuffers[2] = { nullptr, nullptr };
+    cl_mem m_ResolvedCellsBuffer = nullptr;
+
+    // Activity tiles are square over the padded grid, the changed flags of a generation are read by the next one while its own are written
+    static constexpr size_t s_ActivityTileSize = 16;
+    size_t m_ActivityGlobalSize[2] = { 1, 1 };
+    cl_mem m_ActiveTilesBuffer = nullptr;
+    cl_mem m_ChangedTilesBuffers[2] = { nullptr, nullptr };
+    // Every tile is flagged as changed before a generation while it is disabled
+    bool m_ActivityTracking = true;
+
+    cl_mem m_CountBuffer = nullptr;
+    // Low words of the three counters then their high words, the device adds to them with 32-bit atomics
+    cl_uint m_CellCounts[6] = { 0, 0, 0, 0, 0, 0 };
+    size_t m_CountLocalSize = 1;
+    size_t m_CountGlobalSize = 1;
+
+    // The buffers swap once per generation, so each parity gets its own bound kernels
+    struct GenerationKernels
+    {
+        cl_kernel Activate = nullptr;
+        cl_kernel Resolve = nullptr;
+        cl_kernel Advance = nullptr;
+        cl_kernel Count = nullptr;
+        cl_kernel Inject = nullptr;
+    };
+
+    GenerationKernels m_GenerationKernels[2];
+
+    // The tiled kernels stage each work-group tile and its halo in local memory, the direct kernels read global memory
+    bool m_TiledKernels = true;
+    cl_uint m_GenerationDimensions = 1;
+    size_t m_GenerationGlobalSize[2] = { 0, 1 };
+    size_t m_GenerationLocalSize[2] = { 1, 1 };
+
+    cl_event m_AdvanceEvent = nullptr;
+    cl_event m_ReadbackEvents[2] = { nullptr, nullptr };
+    std::vector<cl_event> m_UploadEvents;
+
+    // Injections are kept as records of the cell, the number of cells and the seed until the next step applies them on the device
+    // The records being uploaded are kept apart from the ones queued since, the buffer only grows
+    std::vector<cl_int4> m_PendingInjections;
+    std::vector<cl_int4> m_UploadedInjections;
+    size_t m_InjectionCapacity = 0;
+    cl_mem m_InjectionBuffer = nullptr;
+    cl_event m_InjectionUploadEvent = nullptr;
+
+private:
+    void mapBuffers(size_t buffer, cl_map_flags flags, cl_bool blocking, const std::vector<cl_event>& waitList, cl_event* event);
+    void unmapBuffers(size_t buffer);
+    void bindKernels();
+
+    // Enqueued after the wait list, the injection replaces it as the command the generation waits on
+    void injectCells(const GenerationKernels& kernels, std::vector<cl_event>& waitList);
+    void countCells(const GenerationKernels& kernels);
+
+public:
+    OpenCLBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border, const std::string& device,
+        bool profiling);
+    ~OpenCLBackend();
+
+    // False when no OpenCL device matched, nothing else may be called then
+    bool isAvailable() const { return m_Available; }
+
+    std::string getName() const override { return "OpenCL (" + m_CLWrapper.getDeviceName() + ")"; }
+
+    void inject(const std::vector<Injection>& injections) override;
+    void step() override;
+    void finish() override;
+    void count(uint64_t counts[3]) override;
+
+    const CellState* getStates() override;
+    void exportStates(CellState* states) override;
+    void importStates(const CellState* states) override;
+    void setActivityTracking(bool enabled) override { m_ActivityTracking = enabled; }
+
+    StageProfiler* getProfiler() override { return &m_Profiler; }
+
+    bool getTiledKernels() const { return m_TiledKernels; }
+    void setTiledKernels(bool tiledKernels);
+};
\ No newline at end of file
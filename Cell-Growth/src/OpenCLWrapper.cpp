@@ -1,106 +1,157 @@
 #include "OpenCLWrapper.h"
 
+#include <fstream>
 #include <streambuf>
 
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
 #define MAX_SOURCE_SIZE (0x100000)
 
-void OpenCLWrapper::Init(const char* kernelPath)
+bool OpenCLWrapper::Init(const char* kernelPath, const std::string& device, bool outOfOrderQueue, bool profiling)
 {
+    Profiling = profiling;
+#ifdef _WIN32
+    // OpenCL.dll is delay-loaded so that the executables start on machines without it, it has to be found before the first call
+    if (!LoadLibraryA("OpenCL.dll"))
+    {
+        SIM_WARN("OpenCL.dll not found");
+        return false;
+    }
+#endif
     cl_uint platformCount = 0;
     cl_int ret = 0;
-    CL_ASSERT(clGetPlatformIDs(0, NULL, &platformCount));
-    ELY_INFO("Number of platforms found: {0}", (unsigned int)platformCount);
+    // Without an installed ICD the loader reports no platform at all
+    if (clGetPlatformIDs(0, NULL, &platformCount) != CL_SUCCESS || platformCount == 0)
+    {
+        SIM_WARN("No OpenCL platform found");
+        return false;
+    }
+    SIM_INFO("Number of platforms found: {0}", (unsigned int)platformCount);
     m_Platforms = (cl_platform_id*)malloc(platformCount * sizeof(cl_platform_id));
     CL_ASSERT(clGetPlatformIDs(platformCount, m_Platforms, NULL));
 
+    // Devices are numbered across platforms in the order they are listed
+    int index = 0;
+    cl_device_id lastDevice = nullptr;
     for (unsigned int i = 0; i < platformCount; i++)
     {
-        cl_device_id device;
-        m_CPU = clGetDeviceIDs(m_Platforms[i], CL_DEVICE_TYPE_CPU, 1, &device, NULL) == CL_SUCCESS ? device : m_CPU;
-        m_GPU = clGetDeviceIDs(m_Platforms[i], CL_DEVICE_TYPE_GPU, 1, &device, NULL) == CL_SUCCESS ? device : m_GPU;
-    }
+        cl_uint deviceCount = 0;
+        if (clGetDeviceIDs(m_Platforms[i], CL_DEVICE_TYPE_ALL, 0, NULL, &deviceCount) != CL_SUCCESS)
+            continue;
+        std::vector<cl_device_id> devices(deviceCount);
+        CL_ASSERT(clGetDeviceIDs(m_Platforms[i], CL_DEVICE_TYPE_ALL, deviceCount, devices.data(), NULL));
 
-    char* value;
-    size_t valueSize;
-    clGetDeviceInfo(m_CPU, CL_DEVICE_NAME, 0, NULL, &valueSize);
-    value = (char*)malloc(valueSize);
-    clGetDeviceInfo(m_CPU, CL_DEVICE_NAME, valueSize, value, NULL);
-    if (value)
-        ELY_INFO("CPU device: {0}", value);
-    else
-        ELY_INFO("CPU device not found!");
-    free(value);
-
-    clGetDeviceInfo(m_GPU, CL_DEVICE_NAME, 0, NULL, &valueSize);
-    value = (char*)malloc(valueSize);
-    clGetDeviceInfo(m_GPU, CL_DEVICE_NAME, valueSize, value, NULL);
-    if (value)
-        ELY_INFO("GPU device: {0}", value);
-    else
-        ELY_INFO("GPU device not found!");
-    free(value);
-
-    size_t maxWorkGroupSize;
-    clGetDeviceInfo(m_GPU, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, 0, NULL, &valueSize);
-    clGetDeviceInfo(m_GPU, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(maxWorkGroupSize), &maxWorkGroupSize, NULL);
-    ELY_INFO("GPU device work group size: {0}", maxWorkGroupSize);
-
-    clProgram programSource = getProgramSoure(kernelPath);
-
-    const char* programSourceStr = programSource.sourceStr.c_str();
-    if (m_CPU)
-    {
-        // Create OpenCL contexts
-        CPUContext = clCreateContext(NULL, 1, &m_CPU, NULL, NULL, &ret);
-        CL_ASSERT(ret);
-        // Create command queues
-        CPUCommandQueue = clCreateCommandQueue(CPUContext, m_CPU, 0, &ret);
-        CL_ASSERT(ret);
-        // Create programs from the kernel source
-        CPUProgram = clCreateProgramWithSource(CPUContext, 1,
-            (const char**)&programSourceStr, (const size_t*)&programSource.sourceSize, &ret);
-        CL_ASSERT(ret);
-        // Build programs
-        CL_ASSERT(ret = clBuildProgram(CPUProgram, 1, &m_CPU, NULL, NULL, NULL));
-        if (ret != CL_SUCCESS)
+        for (cl_device_id candidate : devices)
         {
-            size_t len;
-            char* buffer;
-            clGetProgramBuildInfo(CPUProgram, m_CPU, CL_PROGRAM_BUILD_LOG, 0, NULL, &len);
-            buffer = new char[len];
-            clGetProgramBuildInfo(CPUProgram, m_CPU, CL_PROGRAM_BUILD_LOG, len, buffer, NULL);
-            ELY_ERROR("Build error: {0}", buffer);
-            delete[] buffer;
+            cl_device_type type = 0;
+            clGetDeviceInfo(candidate, CL_DEVICE_TYPE, sizeof(type), &type, NULL);
+            SIM_INFO("OpenCL device {0}: {1}", index, getDeviceString(candidate, CL_DEVICE_NAME));
+            if (matchDevice(device, type, index))
+                m_Device = candidate;
+            lastDevice = candidate;
+            index++;
         }
     }
-    if (m_GPU)
+
+    // Any device is preferably a GPU
+    if (!m_Device && device == "any")
+        m_Device = lastDevice;
+
+    if (!m_Device)
+    {
+        SIM_WARN("No OpenCL device matches: {0}", device);
+        free(m_Platforms);
+        m_Platforms = nullptr;
+        return false;
+    }
+
+    SIM_INFO("Device: {0}", getDeviceName());
+
+    HostUnifiedMemory = hasHostUnifiedMemory(m_Device);
+    SIM_INFO("Device host unified memory: {0}", HostUnifiedMemory);
+
+    size_t maxWorkGroupSize = 0;
+    clGetDeviceInfo(m_Device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(maxWorkGroupSize), &maxWorkGroupSize, NULL);
+    SIM_INFO("Device work group size: {0}", maxWorkGroupSize);
+
+    m_KernelPath = kernelPath;
+    m_ProgramSource = getProgramSoure(kernelPath);
+
+    Context = clCreateContext(NULL, 1, &m_Device, NULL, NULL, &ret);
+    CL_ASSERT(ret);
+    cl_command_queue_properties queueProperties = 0;
+    if (outOfOrderQueue)
     {
-        GPUContext = clCreateContext(NULL, 1, &m_GPU, NULL, NULL, &ret);
-        CL_ASSERT(ret);
-        GPUCommandQueue = clCreateCommandQueue(GPUContext, m_GPU, 0, &ret);
-        CL_ASSERT(ret);
-        GPUProgram = clCreateProgramWithSource(GPUContext, 1,
-            (const char**)&programSourceStr, (const size_t*)&programSource.sourceSize, &ret);
-        CL_ASSERT(ret);
-        CL_ASSERT(clBuildProgram(GPUProgram, 1, &m_GPU, NULL, NULL, NULL));
+        cl_command_queue_properties supportedProperties = 0;
+        clGetDeviceInfo(m_Device, CL_DEVICE_QUEUE_PROPERTIES, sizeof(supportedProperties), &supportedProperties, NULL);
+        queueProperties = supportedProperties & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+        SIM_INFO("Out of order queue: {0}", queueProperties ? "enabled" : "not supported");
     }
+    if (profiling)
+        queueProperties |= CL_QUEUE_PROFILING_ENABLE;
+    CommandQueue = clCreateCommandQueue(Context, m_Device, queueProperties, &ret);
+    CL_ASSERT(ret);
+    return true;
 }
 
 void OpenCLWrapper::Shutdown()
 {
-    CL_ASSERT(clFlush(CPUCommandQueue));
-    CL_ASSERT(clFinish(CPUCommandQueue));
-    CL_ASSERT(clReleaseProgram(CPUProgram));
-    CL_ASSERT(clReleaseCommandQueue(CPUCommandQueue));
-    CL_ASSERT(clReleaseContext(CPUContext));
-
-    CL_ASSERT(clFlush(GPUCommandQueue));
-    CL_ASSERT(clFinish(GPUCommandQueue));
-    CL_ASSERT(clReleaseProgram(GPUProgram));
-    CL_ASSERT(clReleaseCommandQueue(GPUCommandQueue));
-    CL_ASSERT(clReleaseContext(GPUContext));
+    for (auto& kernel : m_Kernels)
+        CL_ASSERT(clReleaseKernel(kernel.second));
+    m_Kernels.clear();
+    for (auto& program : m_Programs)
+        CL_ASSERT(clReleaseProgram(program.second));
+    m_Programs.clear();
+
+    if (m_Device)
+    {
+        CL_ASSERT(clFlush(CommandQueue));
+        CL_ASSERT(clFinish(CommandQueue));
+        CL_ASSERT(clReleaseCommandQueue(CommandQueue));
+        CL_ASSERT(clReleaseContext(Context));
+    }
 
     free(m_Platforms);
+    m_Platforms = nullptr;
+    m_Device = nullptr;
+}
+
+bool OpenCLWrapper::matchDevice(const std::string& selector, cl_device_type type, int index)
+{
+    if (selector == "gpu" || selector == "any")
+        return (type & CL_DEVICE_TYPE_GPU) != 0;
+    if (selector == "cpu")
+        return (type & CL_DEVICE_TYPE_CPU) != 0;
+    return selector == std::to_string(index);
+}
+
+cl_kernel OpenCLWrapper::getKernel(cl_program program, const std::string& name, unsigned int variant)
+{
+    KernelKey key = { program, name, variant };
+    auto it = m_Kernels.find(key);
+    if (it != m_Kernels.end())
+        return it->second;
+
+    cl_int ret = 0;
+    cl_kernel kernel = clCreateKernel(program, name.c_str(), &ret);
+    CL_ASSERT(ret);
+    m_Kernels[key] = kernel;
+    return kernel;
+}
+
+cl_program OpenCLWrapper::getProgram(const std::string& options)
+{
+    auto it = m_Programs.find(options);
+    if (it != m_Programs.end())
+        return it->second;
+
+    SIM_INFO("Building program with options: {0}", options);
+    cl_program program = buildProgram(Context, m_Device, m_ProgramSource, m_KernelPath.c_str(), options);
+    m_Programs[options] = program;
+    return program;
 }
 
 clProgram OpenCLWrapper::getProgramSoure(const char* filepath)
@@ -111,7 +162,7 @@ clProgram OpenCLWrapper::getProgramSoure(const char* filepath)
 
     if (!file.is_open())
     {
-        ELY_ERROR("Cannot open kernel: {0}", filepath);
+        SIM_ERROR("Cannot open kernel: {0}", filepath);
         return kernel;
     }
 
@@ -126,6 +177,134 @@ clProgram OpenCLWrapper::getProgramSoure(const char* filepath)
     return kernel;
 }
 
+cl_program OpenCLWrapper::buildProgram(cl_context context, cl_device_id device, const clProgram& source, const char* kernelPath, const std::string& options)
+{
+    cl_int ret = 0;
+    std::string deviceName = getDeviceString(device, CL_DEVICE_NAME);
+    std::string key = deviceName + "\n" + getDeviceString(device, CL_DRIVER_VERSION) + "\n" + options + "\n"
+        + std::to_string(hashString(source.sourceStr));
+    std::string cachePath = std::string(kernelPath) + "." + std::to_string(hashString(deviceName + "\n" + options)) + ".bin";
+
+    std::vector<unsigned char> binary;
+    if (readProgramBinary(cachePath, key, binary))
+    {
+        const unsigned char* binaryData = binary.data();
+        size_t binarySize = binary.size();
+        cl_int binaryStatus = CL_SUCCESS;
+        cl_program program = clCreateProgramWithBinary(context, 1, &device, &binarySize, &binaryData, &binaryStatus, &ret);
+        if (ret == CL_SUCCESS && binaryStatus == CL_SUCCESS && clBuildProgram(program, 1, &device, options.c_str(), NULL, NULL) == CL_SUCCESS)
+        {
+            SIM_INFO("Program loaded from binary: {0}", cachePath);
+            return program;
+        }
+        if (program)
+            clReleaseProgram(program);
+        SIM_INFO("Program binary rejected, building from source: {0}", cachePath);
+    }
+
+    const char* sourceStr = source.sourceStr.c_str();
+    size_t sourceSize = source.sourceStr.size();
+    cl_program program = clCreateProgramWithSource(context, 1, &sourceStr, &sourceSize, &ret);
+    CL_ASSERT(ret);
+    CL_ASSERT(ret = clBuildProgram(program, 1, &device, options.c_str(), NULL, NULL));
+    if (ret != CL_SUCCESS)
+    {
+        size_t len;
+        char* buffer;
+        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, NULL, &len);
+        buffer = new char[len];
+        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, len, buffer, NULL);
+        SIM_ERROR("Build error: {0}", buffer);
+        delete[] buffer;
+        return program;
+    }
+
+    writeProgramBinary(cachePath, key, program);
+    return program;
+}
+
+bool OpenCLWrapper::readProgramBinary(const std::string& path, const std::string& key, std::vector<unsigned char>& binary)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    uint64_t keySize = 0;
+    file.read((char*)&keySize, sizeof(keySize));
+    if (!file || keySize != key.size())
+        return false;
+    std::string fileKey(key.size(), '\0');
+    file.read(&fileKey[0], keySize);
+    if (!file || fileKey != key)
+        return false;
+
+    uint64_t binarySize = 0;
+    file.read((char*)&binarySize, sizeof(binarySize));
+    if (!file || binarySize == 0)
+        return false;
+    binary.resize((size_t)binarySize);
+    file.read((char*)binary.data(), binarySize);
+    return (bool)file;
+}
+
+void OpenCLWrapper::writeProgramBinary(const std::string& path, const std::string& key, cl_program program)
+{
+    // Programs are built for a single device, so there is a single binary
+    size_t binarySize = 0;
+    CL_ASSERT(clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(binarySize), &binarySize, NULL));
+    if (binarySize == 0)
+        return;
+    std::vector<unsigned char> binary(binarySize);
+    unsigned char* binaryData = binary.data();
+    CL_ASSERT(clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaryData), &binaryData, NULL));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        SIM_ERROR("Cannot write program binary: {0}", path);
+        return;
+    }
+
+    uint64_t keySize = key.size();
+    uint64_t fileBinarySize = binarySize;
+    file.write((const char*)&keySize, sizeof(keySize));
+    file.write(key.data(), key.size());
+    file.write((const char*)&fileBinarySize, sizeof(fileBinarySize));
+    file.write((const char*)binary.data(), binary.size());
+}
+
+std::string OpenCLWrapper::getDeviceString(cl_device_id device, cl_device_info info)
+{
+    size_t valueSize = 0;
+    if (clGetDeviceInfo(device, info, 0, NULL, &valueSize) != CL_SUCCESS || valueSize == 0)
+        return "";
+    std::string value(valueSize, '\0');
+    clGetDeviceInfo(device, info, valueSize, &value[0], NULL);
+    value.resize(valueSize - 1);
+    return value;
+}
+
+uint64_t OpenCLWrapper::hashString(const std::string& str)
+{
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : str)
+    {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool OpenCLWrapper::hasHostUnifiedMemory(cl_device_id device)
+{
+    cl_device_type type = 0;
+    cl_bool hostUnifiedMemory = CL_FALSE;
+    clGetDeviceInfo(device, CL_DEVICE_TYPE, sizeof(type), &type, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(hostUnifiedMemory), &hostUnifiedMemory, NULL);
+    return (type & CL_DEVICE_TYPE_CPU) || hostUnifiedMemory == CL_TRUE;
+}
+
 const char* OpenCLWrapper::getCLError(int ret)
 {
     switch (ret)
@@ -206,5 +385,5 @@ void OpenCLWrapper::logCLError(int ret, const char* file, int line)
 {
     const char* errorMessage = getCLError(ret);
     if (errorMessage)
-        ELY_ERROR("{0} in file {1}: {2}", errorMessage, file, line);
+        SIM_ERROR("{0} in file {1}: {2}", errorMessage, file, line);
 }
\ No newline at end of file
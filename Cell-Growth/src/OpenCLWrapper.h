@@ -2,7 +2,13 @@
 
 #include <CL/cl.h>
 
-#include <Elysium.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "SimulationLog.h"
 
 struct clProgram
 {
@@ -14,26 +20,59 @@ class OpenCLWrapper
 {
 private:
     cl_platform_id* m_Platforms = nullptr;
-    cl_device_id m_CPU;
-    cl_device_id m_GPU;
+    cl_device_id m_Device = nullptr;
+
+    using KernelKey = std::tuple<cl_program, std::string, unsigned int>;
+    std::map<KernelKey, cl_kernel> m_Kernels;
+
+    std::string m_KernelPath;
+    clProgram m_ProgramSource;
+    std::map<std::string, cl_program> m_Programs;
 
 private:
     clProgram getProgramSoure(const char* filepath);
 
+    // Programs are loaded from a binary cached next to the kernel source, the source is only built when the cache is missing or stale
+    cl_program buildProgram(cl_context context, cl_device_id device, const clProgram& source, const char* kernelPath, const std::string& options);
+    static bool readProgramBinary(const std::string& path, const std::string& key, std::vector<unsigned char>& binary);
+    static void writeProgramBinary(const std::string& path, const std::string& key, cl_program program);
+
+    static std::string getDeviceString(cl_device_id device, cl_device_info info);
+    static uint64_t hashString(const std::string& str);
+
+    static bool matchDevice(const std::string& selector, cl_device_type type, int index);
+
     static const char* getCLError(int ret);
+    static bool hasHostUnifiedMemory(cl_device_id device);
 
 public:
-    cl_context CPUContext;
-    cl_context GPUContext;
-    cl_command_queue CPUCommandQueue;
-    cl_command_queue GPUCommandQueue;
-    cl_program CPUProgram;
-    cl_program GPUProgram;
+    cl_context Context = nullptr;
+    cl_command_queue CommandQueue = nullptr;
+
+    // The device shares memory with the host, buffers can be mapped instead of copied
+    bool HostUnifiedMemory = false;
+
+public:
+    // Commands of profiled queues record their queued, submit, start and end times
+    bool Profiling = false;
 
 public:
-    void Init(const char* kernelPath);
+    // The device is "gpu", "cpu", "any" or its index among the devices of every platform, the last match wins
+    // The out of order queue is only used when the device supports it, commands then have to be chained with events
+    // Returns false when no device matches, the simulation then has to run on the host
+    bool Init(const char* kernelPath, const std::string& device = "gpu", bool outOfOrderQueue = false, bool profiling = false);
     void Shutdown();
 
+    cl_device_id getDevice() const { return m_Device; }
+    std::string getDeviceName() const { return getDeviceString(m_Device, CL_DEVICE_NAME); }
+
+    // Program built with -D build options, one per option set, the values become compile-time constants in the kernels
+    // Programs are only built when first asked for, empty options build the generic program
+    cl_program getProgram(const std::string& options);
+
+    // Kernels are created once per program, name and variant and keep their bound arguments until shutdown
+    cl_kernel getKernel(cl_program program, const std::string& name, unsigned int variant = 0);
+
     static void logCLError(int ret, const char* file, int line);
 };
 
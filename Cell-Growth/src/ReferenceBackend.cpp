@@ -0,0 +1,163 @@
+#include "ReferenceBackend.h"
+
+#include <algorithm>
+
+ReferenceBackend::ReferenceBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border) :
+    m_NumberOfCellX(numberOfCellInX),
+    m_NumberOfCellY(numberOfCellInY),
+    m_NumberOfCell(numberOfCellInX * numberOfCellInY),
+    m_RowsPerPartition(std::max(rowsPerPartition, (size_t)1)),
+    m_Layout(numberOfCellInX, numberOfCellInY, m_RowsPerPartition)
+{
+    // Ghosts are never stepped, they keep these values in both generations
+    for (size_t i = 0; i < 2; i++)
+    {
+        m_States[i].allocate(m_Layout.NumberOfCell);
+        m_Layout.fillGhosts(m_States[i].data(), getBorderCell(border), VoidCell);
+    }
+    m_ResolvedCells.allocate(m_Layout.NumberOfCell);
+    m_Layout.fillGhosts(m_ResolvedCells.data(), getBorderCell(border), VoidCell);
+    m_ViewStates.allocate(m_NumberOfCell);
+}
+
+bool ReferenceBackend::inPartition(size_t x, size_t y, int direction) const
+{
+    // Unsigned wrap around makes the cells before the first row or column out of range too
+    size_t neighborX = x + NeighborOffsetX[direction];
+    size_t neighborY = y + NeighborOffsetY[direction];
+    return neighborX < m_NumberOfCellX && neighborY < m_NumberOfCellY
+        && neighborY / m_RowsPerPartition == y / m_RowsPerPartition;
+}
+
+bool ReferenceBackend::isConsumed(size_t i) const
+{
+    for (int j = 0; j < 8; j++)
+    {
+        if (m_ResolvedCells[i + m_Layout.getOffset(j)] == CellCured)
+            return true;
+    }
+    return false;
+}
+
+void ReferenceBackend::inject(const std::vector<Injection>& injections)
+{
+    CellState* states = m_States[m_Front].data();
+    for (const Injection& injection : injections)
+    {
+        size_t x = injection.Index % m_NumberOfCellX;
+        size_t y = injection.Index / m_NumberOfCellX;
+        int numberOfCells = getNumberOfInjectedCells(injection);
+        int counter = 0;
+        for (int j = 0; j < 8; j++)
+        {
+            if (!inPartition(x, y, j))
+                continue;
+
+            counter++;
+            if (counter >= numberOfCells)
+                break;
+
+            size_t neighbor = m_Layout.getIndex(x, y) + m_Layout.getOffset(j);
+            if (getCellType(states[neighbor]) != CellType::MEDECINE)
+                states[neighbor] = packMedecine(getCellType(states[neighbor]), j);
+        }
+    }
+}
+
+void ReferenceBackend::step()
+{
+    const CellState* states = m_States[m_Front].data();
+    CellState* nextStates = m_States[m_Front ^ 1].data();
+
+    // Healthy cells surrounded by cancer become cancer, cancer cells surrounded by medecine are cured
+    for (size_t y = 0; y < m_NumberOfCellY; y++)
+    {
+        for (size_t x = 0; x < m_NumberOfCellX; x++)
+        {
+            size_t i = m_Layout.getIndex(x, y);
+            CellType type = getCellType(states[i]);
+            uint8_t resolved = (uint8_t)type;
+            if (type == CellType::HEALTHY || type == CellType::CANCER)
+            {
+                CellType target = type == CellType::HEALTHY ? CellType::CANCER : CellType::MEDECINE;
+                int count = 0;
+                for (int j = 0; j < 8; j++)
+                {
+                    if (getCellType(states[i + m_Layout.getOffset(j)]) == target)
+                        count++;
+                }
+
+                if (type == CellType::HEALTHY && count >= CancerThreshold)
+                    resolved = (uint8_t)CellType::CANCER;
+                else if (type == CellType::CANCER && count >= CureThreshold)
+                    resolved = CellCured;
+            }
+            m_ResolvedCells[i] = resolved;
+        }
+    }
+
+    for (size_t y = 0; y < m_NumberOfCellY; y++)
+    {
+        for (size_t x = 0; x < m_NumberOfCellX; x++)
+        {
+            size_t i = m_Layout.getIndex(x, y);
+
+            // Cured cells become healthy, medecine next to a cured cell is consumed
+            uint8_t resolved = m_ResolvedCells[i];
+            bool medecine = resolved == (uint8_t)CellType::MEDECINE;
+            CellType type = resolved == CellCured ? CellType::HEALTHY : (CellType)resolved;
+            if (medecine && isConsumed(i))
+            {
+                type = CellType::HEALTHY;
+                medecine = false;
+            }
+            bool occupied = type == CellType::MEDECINE;
+
+            // Medecine restores the cell it was covering before moving on
+            if (medecine)
+                type = getPreviousCellType(states[i]);
+
+            // Medecine moving into this cell, the first neighbor in offset order wins
+            CellState nextState = (CellState)type;
+            for (int j = 0; j < 8 && !occupied; j++)
+            {
+                size_t source = i + m_Layout.getSourceOffset(y, j);
+                CellState sourceState = states[source];
+                if (getCellType(sourceState) == CellType::MEDECINE && getCellDirection(sourceState) == j && !isConsumed(source))
+                {
+                    nextState = packMedecine(type, j);
+                    break;
+                }
+            }
+            nextStates[i] = nextState;
+        }
+    }
+    m_Front ^= 1;
+}
+
+void ReferenceBackend::count(uint64_t counts[3])
+{
+    counts[0] = counts[1] = counts[2] = 0;
+    const CellState* states = m_States[m_Front].data();
+    for (size_t y = 0; y < m_NumberOfCellY; y++)
+    {
+        for (size_t x = 0; x < m_NumberOfCellX; x++)
+            counts[states[m_Layout.getIndex(x, y)] & CellTypeMask]++;
+    }
+}
+
+const CellState* ReferenceBackend::getStates()
+{
+    m_Layout.unpack(m_States[m_Front].data(), m_ViewStates.data());
+    return m_ViewStates.data();
+}
+
+void ReferenceBackend::exportStates(CellState* states)
+{
+    m_Layout.unpack(m_States[m_Front].data(), states);
+}
+
+void ReferenceBackend::importStates(const CellState* states)
+{
+    m_Layout.pack(states, m_States[m_Front].data());
+}
\ No newline at end of file
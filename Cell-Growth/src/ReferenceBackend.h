@@ -0,0 +1,38 @@
+#pragma once
+
+#include "AlignedArray.h"
+#include "SimulationBackend.h"
+
+// Scalar single threaded transcription of the rules, kept simple to check the other backends against
+class ReferenceBackend : public SimulationBackend
+{
+private:
+    const size_t m_NumberOfCellX;
+    const size_t m_NumberOfCellY;
+    const size_t m_NumberOfCell;
+    const size_t m_RowsPerPartition;
+    const GhostLayout m_Layout;
+
+    // States and resolved cells are stored with their ghosts, the view is unpacked from them when asked for
+    size_t m_Front = 0;
+    AlignedArray<CellState> m_States[2];
+    AlignedArray<uint8_t> m_ResolvedCells;
+    AlignedArray<CellState> m_ViewStates;
+
+private:
+    bool inPartition(size_t x, size_t y, int direction) const;
+    bool isConsumed(size_t i) const;
+
+public:
+    ReferenceBackend(size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition, BorderFill border = BorderFill::EMPTY);
+
+    std::string getName() const override { return "Reference"; }
+
+    void inject(const std::vector<Injection>& injections) override;
+    void step() override;
+    void count(uint64_t counts[3]) override;
+
+    const CellState* getStates() override;
+    void exportStates(CellState* states) override;
+    void importStates(const CellState* states) override;
+};
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "SeedPattern.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Cells drawn by one task of the radix select, a histogram is kept per chunk so the tasks never share one
+constexpr size_t CellsPerChunk = 1 << 18;
+
+void multiply(uint32_t a, uint32_t b, uint32_t& high, uint32_t& low)
+{
+    uint64_t product = (uint64_t)a * b;
+    high = (uint32_t)(product >> 32);
+    low = (uint32_t)product;
+}
+
+}
+
+SeedPattern::SeedPattern(uint64_t seed, double cancerDensity) :
+    m_Seed(seed)
+{
+    // Draws below the density scaled to 32 bits, whatever their index
+    if (cancerDensity >= 1.0)
+        m_ThresholdDraw = (uint64_t)1 << 32;
+    else if (cancerDensity > 0.0)
+        m_ThresholdDraw = (uint64_t)(cancerDensity * 4294967296.0);
+}
+
+SeedPattern::SeedPattern(uint64_t seed, size_t numberOfCell, size_t numberOfCancerCells, WorkStealingPool& pool) :
+    m_Seed(seed)
+{
+    if (numberOfCancerCells == 0)
+        return;
+    if (numberOfCancerCells >= numberOfCell)
+    {
+        m_ThresholdDraw = (uint64_t)1 << 32;
+        return;
+    }
+
+    // The threshold is the key of rank numberOfCancerCells, the bucket of its top bits is found first
+    // Only the keys of that bucket are kept, about one cell in two thousand, and the threshold is selected among them
+    constexpr uint32_t Shift = 21;
+    constexpr size_t Buckets = 2048;
+    size_t numberOfChunks = (numberOfCell + CellsPerChunk - 1) / CellsPerChunk;
+    std::vector<uint32_t> histograms(numberOfChunks * Buckets, 0);
+    pool.parallelFor(numberOfChunks, [this, numberOfCell, &histograms](size_t chunk)
+    {
+        uint32_t* histogram = histograms.data() + chunk * Buckets;
+        size_t end = std::min((chunk + 1) * CellsPerChunk, numberOfCell);
+        for (size_t i = chunk * CellsPerChunk; i < end; i += 4)
+        {
+            uint32_t words[4];
+            draw(m_Seed, i / 4, words);
+            for (size_t j = 0; j < 4 && i + j < end; j++)
+                histogram[words[j] >> Shift]++;
+        }
+    });
+
+    size_t rank = numberOfCancerCells;
+    uint32_t bucket = 0;
+    for (;; bucket++)
+    {
+        size_t count = 0;
+        for (size_t chunk = 0; chunk < numberOfChunks; chunk++)
+            count += histograms[chunk * Buckets + bucket];
+        if (rank < count)
+            break;
+        rank -= count;
+    }
+
+    // Keys are the draw then the whole index, cells with the same draw are ordered by their index
+    using Key = std::pair<uint32_t, uint64_t>;
+    std::vector<std::vector<Key>> candidates(numberOfChunks);
+    pool.parallelFor(numberOfChunks, [this, numberOfCell, bucket, &candidates](size_t chunk)
+    {
+        size_t end = std::min((chunk + 1) * CellsPerChunk, numberOfCell);
+        for (size_t i = chunk * CellsPerChunk; i < end; i += 4)
+        {
+            uint32_t words[4];
+            draw(m_Seed, i / 4, words);
+            for (size_t j = 0; j < 4 && i + j < end; j++)
+            {
+                if (words[j] >> Shift == bucket)
+                    candidates[chunk].emplace_back(words[j], (uint64_t)(i + j));
+            }
+        }
+    });
+
+    std::vector<Key> keys;
+    for (const std::vector<Key>& chunkCandidates : candidates)
+        keys.insert(keys.end(), chunkCandidates.begin(), chunkCandidates.end());
+    std::nth_element(keys.begin(), keys.begin() + rank, keys.end());
+    m_ThresholdDraw = keys[rank].first;
+    m_ThresholdIndex = keys[rank].second;
+}
+
+void SeedPattern::draw(uint64_t seed, uint64_t block, uint32_t words[4])
+{
+    // Philox4x32-10 from Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"
+    uint32_t counter[4] = { (uint32_t)block, (uint32_t)(block >> 32), 0, 0 };
+    uint32_t key[2] = { (uint32_t)seed, (uint32_t)(seed >> 32) };
+    for (int round = 0; round < 10; round++)
+    {
+        uint32_t high0;
+        uint32_t low0;
+        uint32_t high1;
+        uint32_t low1;
+        multiply(0xD2511F53, counter[0], high0, low0);
+        multiply(0xCD9E8D57, counter[2], high1, low1);
+        counter[0] = high1 ^ counter[1] ^ key[0];
+        counter[1] = low1;
+        counter[2] = high0 ^ counter[3] ^ key[1];
+        counter[3] = low0;
+        key[0] += 0x9E3779B9;
+        key[1] += 0xBB67AE85;
+    }
+    for (int i = 0; i < 4; i++)
+        words[i] = counter[i];
+}
+
+void SeedPattern::generate(size_t firstCell, size_t numberOfCells, CellState* states) const
+{
+    size_t end = firstCell + numberOfCells;
+    for (size_t i = firstCell; i < end;)
+    {
+        uint32_t words[4];
+        draw(m_Seed, i / 4, words);
+        for (size_t j = i % 4; j < 4 && i < end; j++, i++)
+            states[i - firstCell] = (CellState)(isCancer(words[j], i) ? CellType::CANCER : CellType::HEALTHY);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "CellState.h"
+#include "WorkStealingPool.h"
+
+// Cancer cells of a new grid, every cell is drawn from a counter-based generator keyed by the seed and its index
+// Cells do not depend on each other, any range of them can be generated on any thread and the grid only depends on the seed
+class SeedPattern
+{
+private:
+    uint64_t m_Seed;
+    // A cell is cancer when its draw, followed by its index to break ties, is below the threshold
+    // The draw of the threshold is 2^32 when every cell is cancer, the keys are unique whatever the number of cells
+    uint64_t m_ThresholdDraw = 0;
+    uint64_t m_ThresholdIndex = 0;
+
+private:
+    bool isCancer(uint32_t draw, uint64_t index) const
+    {
+        return draw < m_ThresholdDraw || (draw == m_ThresholdDraw && index < m_ThresholdIndex);
+    }
+
+public:
+    // Every cell is cancer with the probability of the density
+    SeedPattern(uint64_t seed, double cancerDensity);
+    // Exactly numberOfCancerCells cells are cancer, the threshold is selected among the draws on the pool
+    SeedPattern(uint64_t seed, size_t numberOfCell, size_t numberOfCancerCells, WorkStealingPool& pool);
+
+    // Draws of four consecutive cells, the first one has an index multiple of four
+    static void draw(uint64_t seed, uint64_t block, uint32_t words[4]);
+
+    void generate(size_t firstCell, size_t numberOfCells, CellState* states) const;
+};
\ No newline at end of file
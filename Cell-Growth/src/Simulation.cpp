@@ -0,0 +1,167 @@
+#include "Simulation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include "AlignedArray.h"
+#include "CrossCheckBackend.h"
+#include "MappedBackend.h"
+#include "SeedPattern.h"
+#include "SimulationLog.h"
+
+#ifndef CELL_GROWTH_NO_OPENCL
+#include "OpenCLBackend.h"
+#endif
+
+namespace {
+
+// Cells seeded by one task
+constexpr size_t CellsPerSeedChunk = 1 << 16;
+
+// Uniform in [0, 1) from the 53 high bits of a draw
+double toUnit(uint64_t bits)
+{
+    return (double)(bits >> 11) / 9007199254740992.0;
+}
+
+}
+
+Simulation::Simulation(size_t numberOfCellInX, size_t numberOfCellInY, const BackendSettings& settings, uint64_t seed, double cancerDensity,
+    bool exactCount) :
+    NumberOfCellX(std::max(numberOfCellInX, (size_t)1)),
+    NumberOfCellY((std::max(numberOfCellInY, (size_t)1) + NumberOfPartitions - 1) / NumberOfPartitions * NumberOfPartitions),
+    NumberOfCell(NumberOfCellX * NumberOfCellY),
+    RowsPerPartition(NumberOfCellY / NumberOfPartitions),
+    m_Border(settings.Border)
+{
+    SIM_INFO("Grid size: {0}x{1}", NumberOfCellX, NumberOfCellY);
+
+    m_Backend = createBackend(settings.Backend, settings);
+    if (!settings.CrossCheck.empty())
+    {
+        std::unique_ptr<SimulationBackend> secondary = createBackend(settings.CrossCheck, settings);
+        m_Backend = std::make_unique<CrossCheckBackend>(std::move(m_Backend), std::move(secondary), NumberOfCellX, NumberOfCellY);
+    }
+    SIM_INFO("Simulation backend: {0}", m_Backend->getName());
+
+    if (cancerDensity < 0.0)
+        cancerDensity = 0.25 + 0.25 * toUnit(std::mt19937_64(seed)());
+    this->seed(seed, std::min(cancerDensity, 1.0), exactCount);
+    finish();
+
+    SIM_INFO("Number of cell per partition: {0}", RowsPerPartition * NumberOfCellX);
+}
+
+std::unique_ptr<SimulationBackend> Simulation::createBackend(const std::string& name, const BackendSettings& settings)
+{
+    std::unique_ptr<SimulationBackend> backend = ::createBackend(name, NumberOfCellX, NumberOfCellY, RowsPerPartition, settings);
+#ifndef CELL_GROWTH_NO_OPENCL
+    if (!m_OpenCLBackend)
+        m_OpenCLBackend = dynamic_cast<OpenCLBackend*>(backend.get());
+#endif
+    return backend;
+}
+
+void Simulation::seed(uint64_t seed, double cancerDensity, bool exactCount)
+{
+    // Cells are drawn independently, the grid is generated in chunks spread over every hardware thread
+    auto start = std::chrono::steady_clock::now();
+    WorkStealingPool pool;
+    size_t numberOfCancerCells = (size_t)(cancerDensity * (double)NumberOfCell + 0.5);
+    SeedPattern pattern = exactCount ? SeedPattern(seed, NumberOfCell, numberOfCancerCells, pool) : SeedPattern(seed, cancerDensity);
+    auto generate = [&pool, &pattern](size_t firstCell, size_t numberOfCells, CellState* states)
+    {
+        pool.parallelFor((numberOfCells + CellsPerSeedChunk - 1) / CellsPerSeedChunk, [&pattern, firstCell, numberOfCells, states](size_t chunk)
+        {
+            size_t begin = chunk * CellsPerSeedChunk;
+            pattern.generate(firstCell + begin, std::min(CellsPerSeedChunk, numberOfCells - begin), states + begin);
+        });
+    };
+
+    // A grid in a file may not fit in memory, it is seeded a band of its tiles at a time
+    if (MappedBackend* mapped = dynamic_cast<MappedBackend*>(m_Backend.get()))
+    {
+        size_t bandRows = MappedTileStore::TileSize;
+        AlignedArray<CellState> band(bandRows * NumberOfCellX);
+        for (size_t y = 0; y < NumberOfCellY; y += bandRows)
+        {
+            size_t numberOfRows = std::min(bandRows, NumberOfCellY - y);
+            generate(y * NumberOfCellX, numberOfRows * NumberOfCellX, band.data());
+            mapped->importRows(y, numberOfRows, band.data());
+        }
+    }
+    else
+    {
+        AlignedArray<CellState> states(NumberOfCell);
+        generate(0, NumberOfCell, states.data());
+        m_Backend->importStates(states.data());
+    }
+
+    double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (exactCount)
+        SIM_INFO("Seed: {0}, cancer cells: {1}, seeded in {2} ms", seed, numberOfCancerCells, time);
+    else
+        SIM_INFO("Seed: {0}, cancer density: {1}, seeded in {2} ms", seed, cancerDensity, time);
+}
+
+void Simulation::finish()
+{
+    m_Backend->finish();
+    m_Backend->count(m_Counts);
+}
+
+void Simulation::inject(const std::vector<Injection>& injections)
+{
+    m_Backend->finish();
+    m_Backend->inject(injections);
+}
+
+void Simulation::step()
+{
+    m_Backend->step();
+    m_Generation++;
+}
+
+void Simulation::fastForward(unsigned int log2Generations)
+{
+    auto start = std::chrono::steady_clock::now();
+    m_Backend->finish();
+    if (!m_HashLife)
+        m_HashLife = std::make_unique<HashLife>(NumberOfCellX, NumberOfCellY, RowsPerPartition, m_Border);
+
+    AlignedArray<CellState> states(NumberOfCell);
+    m_Backend->exportStates(states.data());
+    m_HashLife->advance(states.data(), log2Generations);
+    m_Backend->importStates(states.data());
+    m_Generation += (uint64_t)1 << log2Generations;
+    finish();
+
+    double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    SIM_INFO("Fast-forwarded {0} generations in {1} ms, {2} HashLife nodes", (uint64_t)1 << log2Generations, time, m_HashLife->getNumberOfNodes());
+}
+
+bool Simulation::isConsistent() const
+{
+    const CrossCheckBackend* crossCheck = dynamic_cast<const CrossCheckBackend*>(m_Backend.get());
+    return !crossCheck || !crossCheck->hasDiverged();
+}
+
+bool Simulation::getTiledKernels() const
+{
+#ifndef CELL_GROWTH_NO_OPENCL
+    return m_OpenCLBackend && m_OpenCLBackend->getTiledKernels();
+#else
+    return false;
+#endif
+}
+
+void Simulation::setTiledKernels(bool tiledKernels)
+{
+#ifndef CELL_GROWTH_NO_OPENCL
+    if (m_OpenCLBackend)
+        m_OpenCLBackend->setTiledKernels(tiledKernels);
+#else
+    (void)tiledKernels;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "HashLife.h"
+#include "SimulationBackend.h"
+
+class OpenCLBackend;
+
+// Grid of cells stepped by a backend, seeded with cancer and healthy cells, with the medecine injected and the cells counted
+// It is the whole simulation without a window or a renderer, the application, the headless runner and the benchmarks drive it
+class Simulation
+{
+public:
+    // The grid is split in NumberOfPartitions partitions of whole rows, the number of rows is rounded up to a multiple of it
+    const size_t NumberOfCellX;
+    const size_t NumberOfCellY;
+    const size_t NumberOfCell;
+    const size_t RowsPerPartition;
+
+private:
+    const BorderFill m_Border;
+    std::unique_ptr<SimulationBackend> m_Backend;
+    // First OpenCL backend created, the kernel choice is only exposed for it
+    OpenCLBackend* m_OpenCLBackend = nullptr;
+    // Created on the first fast-forward, its cache is kept for the next ones
+    std::unique_ptr<HashLife> m_HashLife;
+
+    uint64_t m_Generation = 0;
+    // Number of cancer, healthy and medecine cells of the last finished generation
+    uint64_t m_Counts[3] = { 0, 0, 0 };
+
+private:
+    std::unique_ptr<SimulationBackend> createBackend(const std::string& name, const BackendSettings& settings);
+    void seed(uint64_t seed, double cancerDensity, bool exactCount);
+
+public:
+    // A negative density draws one between a quarter and half of the cells from the seed
+    // With an exact count the density is the fraction of cancer cells, rounded to a whole number of them, instead of their probability
+    Simulation(size_t numberOfCellInX, size_t numberOfCellInY, const BackendSettings& settings, uint64_t seed, double cancerDensity = -1.0,
+        bool exactCount = false);
+
+    // Waits for the generation in flight and counts it
+    void finish();
+    // Applied to the finished generation, before the next step
+    void inject(const std::vector<Injection>& injections);
+    // Starts computing the next generation, it may still be running when the call returns
+    void step();
+    // Jumps 2^log2Generations generations ahead without injections
+    void fastForward(unsigned int log2Generations);
+
+    uint64_t getGeneration() const { return m_Generation; }
+    uint64_t getNumberOfCancerCells() const { return m_Counts[0]; }
+    uint64_t getNumberOfHealthyCells() const { return m_Counts[1]; }
+    uint64_t getNumberOfMedecineCells() const { return m_Counts[2]; }
+
+    // View of the last generation stepped, valid until the next step
+    const CellState* getStates() { return m_Backend->getStates(); }
+    // Copies the last finished generation to the host
+    void exportStates(CellState* states) { m_Backend->exportStates(states); }
+    std::string getBackendName() const { return m_Backend->getName(); }
+    // Steps every tile while disabled, the benchmarks time whole generations with it
+    void setActivityTracking(bool enabled) { m_Backend->setActivityTracking(enabled); }
+    StageProfiler* getProfiler() { return m_Backend->getProfiler(); }
+    // False once a cross-checked backend diverged
+    bool isConsistent() const;
+
+    bool hasTiledKernels() const { return m_OpenCLBackend != nullptr; }
+    bool getTiledKernels() const;
+    void setTiledKernels(bool tiledKernels);
+};
\ No newline at end of file
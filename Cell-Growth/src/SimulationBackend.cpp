@@ -0,0 +1,46 @@
+#include "SimulationBackend.h"
+
+#include "BitboardBackend.h"
+#include "CpuBackend.h"
+#include "MappedBackend.h"
+#include "ReferenceBackend.h"
+#include "SimulationLog.h"
+
+#ifndef CELL_GROWTH_NO_OPENCL
+#include "OpenCLBackend.h"
+#endif
+
+std::unique_ptr<SimulationBackend> createBackend(const std::string& name, size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition,
+    const BackendSettings& settings)
+{
+    if (name == "reference")
+        return std::make_unique<ReferenceBackend>(numberOfCellInX, numberOfCellInY, rowsPerPartition, settings.Border);
+    if (name == "bitboard")
+        return std::make_unique<BitboardBackend>(numberOfCellInX, numberOfCellInY, rowsPerPartition, settings.Border, settings.Profiling);
+
+    if (name == "mapped")
+    {
+        std::unique_ptr<MappedBackend> backend = std::make_unique<MappedBackend>(numberOfCellInX, numberOfCellInY, rowsPerPartition,
+            settings.Border, settings.MappedFile, settings.ResidentMegabytes << 20, settings.Profiling);
+        if (backend->isAvailable())
+            return backend;
+        SIM_WARN("The grid file is not available, simulating in memory");
+    }
+    else if (name == "opencl")
+    {
+#ifndef CELL_GROWTH_NO_OPENCL
+        std::unique_ptr<OpenCLBackend> backend = std::make_unique<OpenCLBackend>(numberOfCellInX, numberOfCellInY, rowsPerPartition,
+            settings.Border, settings.Device, settings.Profiling);
+        if (backend->isAvailable())
+            return backend;
+        SIM_WARN("OpenCL is not available, simulating on the host");
+#else
+        SIM_WARN("Built without OpenCL, simulating on the host");
+#endif
+    }
+    else if (name != "cpu")
+    {
+        SIM_WARN("Unknown simulation backend: {0}", name);
+    }
+    return std::make_unique<CpuBackend>(numberOfCellInX, numberOfCellInY, rowsPerPartition, settings.Border, settings.Profiling);
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CellState.h"
+#include "GhostLayout.h"
+
+class StageProfiler;
+
+// Neighbors are only counted inside partitions of whole rows, the grid has this many of them
+static constexpr size_t NumberOfPartitions = 4;
+
+// Medecine dropped around a cell, it covers the first NumberOfCells - 1 neighbors of the cell inside its partition
+// Without a number of cells, it is drawn between 1 and 8 from the seed
+struct Injection
+{
+    size_t Index;
+    int NumberOfCells;
+    uint32_t Seed = 0;
+};
+
+// It has to match get_injected_cells in res/cl/cell_kernel.cl
+inline int getNumberOfInjectedCells(const Injection& injection)
+{
+    if (injection.NumberOfCells > 0)
+        return injection.NumberOfCells;
+
+    uint32_t hash = injection.Seed;
+    hash ^= hash >> 16;
+    hash *= 0x7FEB352D;
+    hash ^= hash >> 15;
+    hash *= 0x846CA68B;
+    hash ^= hash >> 16;
+    return 1 + (int)(hash % 8);
+}
+
+struct BackendSettings
+{
+    // "opencl", "cpu", "bitboard", "mapped" or "reference"
+    std::string Backend = "opencl";
+    // OpenCL device, "gpu", "cpu", "any" or its index among the listed devices
+    std::string Device = "gpu";
+    // Second backend run in lockstep with the first one, every generation is compared when it is set
+    std::string CrossCheck;
+    bool Profiling = false;
+    // File holding the grid of the mapped backend, a temporary file when empty, and how much of it stays in memory
+    std::string MappedFile;
+    size_t ResidentMegabytes = 256;
+    // What the cells on the border of the grid see beyond it, every backend stores the grid with a ghost ring holding it
+    BorderFill Border = BorderFill::EMPTY;
+};
+
+// Engine computing the generations of a grid, every implementation has to produce exactly the cells of the kernels
+class SimulationBackend
+{
+public:
+    virtual ~SimulationBackend() = default;
+
+    virtual std::string getName() const = 0;
+
+    // Injections are applied to the current generation, before the next step
+    virtual void inject(const std::vector<Injection>& injections) = 0;
+    // Starts computing the next generation, it may still be running when the call returns
+    virtual void step() = 0;
+    // Waits for the generation in flight, the states and counts describe it afterwards
+    virtual void finish() {}
+
+    // Number of cancer, healthy and medecine cells of the current generation, 64 bits as grids may hold more than 2^32 cells
+    virtual void count(uint64_t counts[3]) = 0;
+
+    // View of the current generation, valid until the next step
+    virtual const CellState* getStates() = 0;
+    virtual void exportStates(CellState* states) = 0;
+    virtual void importStates(const CellState* states) = 0;
+
+    // Backends skipping the tiles that did not change step all of them while it is disabled
+    virtual void setActivityTracking(bool) {}
+
+    // Backends timing their passes or device commands have a profiler, it only samples when profiling was asked for
+    virtual StageProfiler* getProfiler() { return nullptr; }
+};
+
+// Unknown names and an unavailable OpenCL device or grid file fall back to the CPU backend
+std::unique_ptr<SimulationBackend> createBackend(const std::string& name, size_t numberOfCellInX, size_t numberOfCellInY, size_t rowsPerPartition,
+    const BackendSettings& settings);
\ No newline at end of file
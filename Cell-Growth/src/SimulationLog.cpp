@@ -0,0 +1,17 @@
+#include "SimulationLog.h"
+
+#include <cstdio>
+
+SimulationLog::Sink SimulationLog::s_Sink;
+
+void SimulationLog::write(LogLevel level, const std::string& message)
+{
+    if (s_Sink)
+    {
+        s_Sink(level, message);
+        return;
+    }
+
+    static const char* const s_LevelNames[] = { "info", "warning", "error" };
+    fprintf(stderr, "[%s] %s\n", s_LevelNames[(int)level], message.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <functional>
+#include <sstream>
+#include <string>
+
+// Not upper case, windows.h defines ERROR
+enum class LogLevel
+{
+    Info,
+    Warning,
+    Error
+};
+
+// Logging of the simulation core, it has no dependency on the engine, which can take the messages over with a sink
+// Messages are written to the standard error by default, "{0}", "{1}"... in the pattern are replaced by the arguments as with spdlog
+class SimulationLog
+{
+public:
+    using Sink = std::function<void(LogLevel, const std::string&)>;
+
+private:
+    static Sink s_Sink;
+
+private:
+    static void append(std::ostringstream&, size_t) {}
+
+    template<typename T, typename... Args>
+    static void append(std::ostringstream& stream, size_t index, const T& argument, const Args&... arguments)
+    {
+        if (index == 0)
+            stream << argument;
+        else
+            append(stream, index - 1, arguments...);
+    }
+
+public:
+    static void setSink(Sink sink) { s_Sink = std::move(sink); }
+    static void write(LogLevel level, const std::string& message);
+
+    template<typename... Args>
+    static std::string format(const char* pattern, const Args&... arguments)
+    {
+        std::ostringstream stream;
+        stream << std::boolalpha;
+        for (const char* c = pattern; *c; c++)
+        {
+            // An index, then an optional specification of which only the hexadecimal "x" and its "#" prefix are known
+            const char* end = c + 1;
+            size_t index = 0;
+            while (*c == '{' && *end >= '0' && *end <= '9')
+                index = index * 10 + (size_t)(*end++ - '0');
+            const char* specification = end;
+            if (*c == '{' && end > c + 1 && *end == ':')
+            {
+                while (*end && *end != '}')
+                    end++;
+            }
+            if (*c != '{' || end == c + 1 || *end != '}')
+            {
+                stream << *c;
+                continue;
+            }
+
+            std::string flags(specification, end);
+            if (flags.find('x') != std::string::npos)
+                stream << std::hex;
+            if (flags.find('#') != std::string::npos)
+                stream << std::showbase;
+            append(stream, index, arguments...);
+            stream << std::dec << std::noshowbase;
+            c = end;
+        }
+        return stream.str();
+    }
+};
+
+#define SIM_INFO(...)  ::SimulationLog::write(LogLevel::Info, ::SimulationLog::format(__VA_ARGS__))
+#define SIM_WARN(...)  ::SimulationLog::write(LogLevel::Warning, ::SimulationLog::format(__VA_ARGS__))
+#define SIM_ERROR(...) ::SimulationLog::write(LogLevel::Error, ::SimulationLog::format(__VA_ARGS__))
\ No newline at end of file
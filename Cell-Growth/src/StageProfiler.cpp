@@ -0,0 +1,98 @@
+#include "StageProfiler.h"
+
+#include <algorithm>
+
+size_t StageProfiler::getStage(const char* name)
+{
+    for (size_t i = 0; i < m_Stages.size(); i++)
+    {
+        if (m_Stages[i].Name == name)
+            return i;
+    }
+    Stage stage;
+    stage.Name = name;
+    m_Stages.push_back(stage);
+    return m_Stages.size() - 1;
+}
+
+void StageProfiler::reset()
+{
+    // The stages are kept, pending device commands refer to them
+    for (Stage& stage : m_Stages)
+    {
+        stage.Durations.clear();
+        stage.SubmitTimes.clear();
+        stage.StartTimes.clear();
+        stage.Bytes.clear();
+        stage.Next = 0;
+    }
+}
+
+void StageProfiler::addSample(size_t stage, double duration, double submitTime, double startTime, size_t bytes)
+{
+    // Rolling window, the oldest sample is overwritten once it is full
+    Stage& samples = m_Stages[stage];
+    if (samples.Durations.size() < s_WindowSize)
+    {
+        samples.Durations.push_back(duration);
+        samples.SubmitTimes.push_back(submitTime);
+        samples.StartTimes.push_back(startTime);
+        samples.Bytes.push_back(bytes);
+    }
+    else
+    {
+        samples.Durations[samples.Next] = duration;
+        samples.SubmitTimes[samples.Next] = submitTime;
+        samples.StartTimes[samples.Next] = startTime;
+        samples.Bytes[samples.Next] = bytes;
+    }
+    samples.Next = (samples.Next + 1) % s_WindowSize;
+}
+
+void StageProfiler::record(const char* name, std::chrono::steady_clock::time_point start, size_t bytes)
+{
+    if (!m_Enabled)
+        return;
+
+    double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    addSample(getStage(name), duration, 0.0, 0.0, bytes);
+}
+
+std::vector<StageProfiler::StageStats> StageProfiler::getStats() const
+{
+    std::vector<StageStats> stats;
+    for (const Stage& stage : m_Stages)
+    {
+        StageStats stageStats;
+        stageStats.Name = stage.Name;
+        stageStats.Samples = stage.Durations.size();
+        if (stageStats.Samples == 0)
+        {
+            stats.push_back(stageStats);
+            continue;
+        }
+
+        double totalDuration = 0.0;
+        double totalSubmitTime = 0.0;
+        double totalStartTime = 0.0;
+        double totalBytes = 0.0;
+        for (size_t i = 0; i < stageStats.Samples; i++)
+        {
+            totalDuration += stage.Durations[i];
+            totalSubmitTime += stage.SubmitTimes[i];
+            totalStartTime += stage.StartTimes[i];
+            totalBytes += (double)stage.Bytes[i];
+        }
+        std::vector<double> sorted = stage.Durations;
+        std::sort(sorted.begin(), sorted.end());
+
+        stageStats.AverageMs = totalDuration / stageStats.Samples;
+        stageStats.P99Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        stageStats.SubmitMs = totalSubmitTime / stageStats.Samples;
+        stageStats.StartMs = totalStartTime / stageStats.Samples;
+        // Bytes per millisecond to GB per second
+        stageStats.GBPerSecond = totalDuration > 0.0 ? totalBytes / totalDuration * 1e-6 : 0.0;
+        stats.push_back(stageStats);
+    }
+    return stats;
+}
\ No newline at end of file
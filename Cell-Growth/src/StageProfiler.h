@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Rolling timings of the passes of a backend, host backends time their passes themselves
+// It has no dependency on OpenCL, device commands are timed through their events by EventProfiler
+class StageProfiler
+{
+public:
+    struct StageStats
+    {
+        std::string Name;
+        size_t Samples = 0;
+        double AverageMs = 0.0;
+        double P99Ms = 0.0;
+        // Time between queuing and submission to the device, then between submission and the start of execution
+        double SubmitMs = 0.0;
+        double StartMs = 0.0;
+        double GBPerSecond = 0.0;
+    };
+
+protected:
+    static constexpr size_t s_WindowSize = 256;
+
+    struct Stage
+    {
+        std::string Name;
+        std::vector<double> Durations;
+        std::vector<double> SubmitTimes;
+        std::vector<double> StartTimes;
+        std::vector<size_t> Bytes;
+        size_t Next = 0;
+    };
+
+    bool m_Enabled = false;
+    std::vector<Stage> m_Stages;
+
+protected:
+    size_t getStage(const char* name);
+    void addSample(size_t stage, double duration, double submitTime, double startTime, size_t bytes);
+
+public:
+    // Drops the samples taken so far, device commands still pending are timed afterwards
+    void reset();
+
+    void setEnabled(bool enabled) { m_Enabled = enabled; }
+    bool isEnabled() const { return m_Enabled; }
+
+    // Times a pass run on the host from its start until now, it has neither submit nor start latency
+    void record(const char* name, std::chrono::steady_clock::time_point start, size_t bytes);
+
+    std::vector<StageStats> getStats() const;
+};
\ No newline at end of file
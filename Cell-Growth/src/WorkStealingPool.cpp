@@ -0,0 +1,113 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(size_t numberOfThreads)
+{
+    if (numberOfThreads == 0)
+        numberOfThreads = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+
+    for (size_t i = 0; i < numberOfThreads; i++)
+        m_Workers.push_back(std::make_unique<Worker>());
+    for (size_t i = 1; i < numberOfThreads; i++)
+        m_Threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_WorkReady.notify_all();
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+bool WorkStealingPool::popTask(size_t worker, Task& task)
+{
+    {
+        Worker& own = *m_Workers[worker];
+        std::lock_guard<std::mutex> lock(own.Mutex);
+        if (!own.Tasks.empty())
+        {
+            task = own.Tasks.back();
+            own.Tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Victims are visited starting after the worker, so thieves spread over the others
+    for (size_t i = 1; i < m_Workers.size(); i++)
+    {
+        Worker& victim = *m_Workers[(worker + i) % m_Workers.size()];
+        std::lock_guard<std::mutex> lock(victim.Mutex);
+        if (!victim.Tasks.empty())
+        {
+            task = victim.Tasks.front();
+            victim.Tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::runTasks(size_t worker)
+{
+    // Tasks are only queued when a loop starts, once every deque is empty there is nothing left for this loop
+    Task task;
+    while (popTask(worker, task))
+    {
+        (*task.Function)(task.Index);
+        if (m_Remaining.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_WorkDone.notify_all();
+        }
+    }
+}
+
+void WorkStealingPool::workerLoop(size_t worker)
+{
+    size_t job = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [this, job] { return m_Stop || m_Job != job; });
+            if (m_Stop)
+                return;
+            job = m_Job;
+        }
+        runTasks(worker);
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t numberOfTasks, const TaskFunction& function)
+{
+    if (numberOfTasks == 0)
+        return;
+
+    m_Remaining = numberOfTasks;
+    for (size_t i = 0; i < m_Workers.size(); i++)
+    {
+        Worker& worker = *m_Workers[i];
+        std::lock_guard<std::mutex> lock(worker.Mutex);
+        // Pushed in reverse, the owner pops the back and works through its block in order
+        size_t begin = numberOfTasks * i / m_Workers.size();
+        size_t end = numberOfTasks * (i + 1) / m_Workers.size();
+        for (size_t task = end; task > begin; task--)
+            worker.Tasks.push_back({ &function, task - 1 });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Job++;
+    }
+    m_WorkReady.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_WorkDone.wait(lock, [this] { return m_Remaining == 0; });
+}
\ No newline at end of file
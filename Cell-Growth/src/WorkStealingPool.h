@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads kept alive between parallel loops, each with its own deque of tasks
+// A worker takes tasks from the back of its deque and steals from the front of the others once it runs dry
+class WorkStealingPool
+{
+public:
+    using TaskFunction = std::function<void(size_t)>;
+
+private:
+    struct Task
+    {
+        const TaskFunction* Function;
+        size_t Index;
+    };
+
+    struct Worker
+    {
+        std::mutex Mutex;
+        std::deque<Task> Tasks;
+    };
+
+    // Worker 0 is the thread calling parallelFor, it works on the loop until it is done
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+    std::vector<std::thread> m_Threads;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    size_t m_Job = 0;
+    bool m_Stop = false;
+    std::atomic<size_t> m_Remaining{ 0 };
+
+private:
+    bool popTask(size_t worker, Task& task);
+    void runTasks(size_t worker);
+    void workerLoop(size_t worker);
+
+public:
+    // One worker per hardware thread when the number of threads is 0
+    explicit WorkStealingPool(size_t numberOfThreads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t getNumberOfThreads() const { return m_Workers.size(); }
+
+    // Calls function(i) for every i below numberOfTasks and returns once all of them are done
+    // Consecutive tasks start on the same worker, they usually touch neighboring memory
+    void parallelFor(size_t numberOfTasks, const TaskFunction& function);
+};
\ No newline at end of file